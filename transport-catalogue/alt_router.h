@@ -0,0 +1,235 @@
+#pragma once
+
+#include "csr_graph.h"
+#include "graph.h"
+#include "route_engine.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Целенаправленный поиск ALT (A*, Landmarks, Triangle inequality).
+// При построении выбираются опорные вершины на периферии графа и считаются расстояния
+// от них и до них. Нижняя оценка расстояния между вершинами берется как максимум из оценок
+// по неравенству треугольника для опорных вершин и внешней оценки lower_bound (если задана).
+// Запрос - двунаправленный A* с усредненными потенциалами, квадратичного предрасчета нет
+template <typename Weight>
+class AltRouter : public RouteEngine<Weight> {
+private:
+    using Graph = CsrGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouteEngine<Weight>::RouteInfo;
+    // Должна быть допустимой и согласованной: не больше длины кратчайшего пути from -> to
+    // и удовлетворять неравенству треугольника на ребрах графа
+    using LowerBound = std::function<double(VertexId from, VertexId to)>;
+
+    static constexpr size_t DEFAULT_LANDMARK_COUNT = 8;
+
+    explicit AltRouter(const Graph& graph, size_t landmark_count = DEFAULT_LANDMARK_COUNT,
+                       LowerBound lower_bound = nullptr);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+    static constexpr double INFINITE_DISTANCE = std::numeric_limits<double>::infinity();
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    struct Landmark {
+        VertexId vertex;
+        std::vector<double> distances_from;  // landmark -> v
+        std::vector<double> distances_to;    // v -> landmark
+    };
+
+    std::vector<double> ComputeDistances(const std::vector<VertexId>& sources, bool reverse) const;
+    void SelectLandmarks(size_t landmark_count);
+    double EstimateDistance(VertexId from, VertexId to) const;
+
+    const Graph& graph_;
+    LowerBound lower_bound_;
+    std::vector<Landmark> landmarks_;
+};
+
+template <typename Weight>
+AltRouter<Weight>::AltRouter(const Graph& graph, size_t landmark_count, LowerBound lower_bound)
+    : graph_(graph)
+    , lower_bound_(std::move(lower_bound))
+{
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < Weight{}) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+    SelectLandmarks(landmark_count);
+}
+
+template <typename Weight>
+std::vector<double> AltRouter<Weight>::ComputeDistances(const std::vector<VertexId>& sources, bool reverse) const {
+    using QueueItem = std::pair<double, VertexId>;
+
+    std::vector<double> distances(graph_.GetVertexCount(), INFINITE_DISTANCE);
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    for (const VertexId source : sources) {
+        distances[source] = 0;
+        queue.push({0, source});
+    }
+    while (!queue.empty()) {
+        const auto [distance, vertex] = queue.top();
+        queue.pop();
+        if (distances[vertex] < distance) {
+            continue;
+        }
+        for (const auto& edge : reverse ? graph_.GetIncomingEdges(vertex) : graph_.GetOutgoingEdges(vertex)) {
+            const double candidate = distance + static_cast<double>(edge.weight);
+            if (candidate < distances[edge.vertex]) {
+                distances[edge.vertex] = candidate;
+                queue.push({candidate, edge.vertex});
+            }
+        }
+    }
+    return distances;
+}
+
+template <typename Weight>
+void AltRouter<Weight>::SelectLandmarks(size_t landmark_count) {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (vertex_count == 0) {
+        return;
+    }
+    landmark_count = std::min(landmark_count, vertex_count);
+
+    // Первая опорная вершина - самая удаленная от вершины 0, каждая следующая - самая удаленная
+    // от уже выбранных. Недостижимые вершины считаются самыми удаленными, поэтому опорные
+    // вершины попадают и в другие компоненты связности
+    std::vector<VertexId> selected;
+    std::vector<double> distances = ComputeDistances({0}, false);
+    while (selected.size() < landmark_count) {
+        VertexId farthest = 0;
+        for (VertexId vertex = 1; vertex < vertex_count; ++vertex) {
+            if (distances[vertex] > distances[farthest]) {
+                farthest = vertex;
+            }
+        }
+        if (distances[farthest] == 0 && !selected.empty()) {
+            break;
+        }
+        selected.push_back(farthest);
+        landmarks_.push_back({farthest, ComputeDistances({farthest}, false), ComputeDistances({farthest}, true)});
+        distances = ComputeDistances(selected, false);
+    }
+}
+
+template <typename Weight>
+double AltRouter<Weight>::EstimateDistance(VertexId from, VertexId to) const {
+    double estimate = lower_bound_ ? lower_bound_(from, to) : 0.0;
+    for (const auto& landmark : landmarks_) {
+        // d(L, to) <= d(L, from) + d(from, to)
+        if (landmark.distances_from[to] != INFINITE_DISTANCE && landmark.distances_from[from] != INFINITE_DISTANCE) {
+            estimate = std::max(estimate, landmark.distances_from[to] - landmark.distances_from[from]);
+        }
+        // d(from, L) <= d(from, to) + d(to, L)
+        if (landmark.distances_to[from] != INFINITE_DISTANCE && landmark.distances_to[to] != INFINITE_DISTANCE) {
+            estimate = std::max(estimate, landmark.distances_to[from] - landmark.distances_to[to]);
+        }
+    }
+    return estimate;
+}
+
+template <typename Weight>
+std::optional<typename AltRouter<Weight>::RouteInfo> AltRouter<Weight>::BuildRoute(VertexId from,
+                                                                                   VertexId to) const {
+    using QueueItem = std::pair<double, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (from == to) {
+        return RouteInfo{Weight{}, {}};
+    }
+
+    // Потенциал прямого поиска (pi_to(v) - pi_from(v)) / 2, обратного - с противоположным знаком.
+    // Вычисляется только для вершин, затронутых поиском
+    std::vector<double> potentials(vertex_count, INFINITE_DISTANCE);
+    const auto potential = [&](VertexId vertex) {
+        if (potentials[vertex] == INFINITE_DISTANCE) {
+            potentials[vertex] = (EstimateDistance(vertex, to) - EstimateDistance(from, vertex)) / 2;
+        }
+        return potentials[vertex];
+    };
+
+    std::vector<Weight> weights[2];
+    std::vector<bool> reached[2];
+    std::vector<EdgeId> parents[2];
+    Queue queues[2];
+    for (int side = 0; side < 2; ++side) {
+        weights[side].assign(vertex_count, Weight{});
+        reached[side].assign(vertex_count, false);
+        parents[side].assign(vertex_count, NO_EDGE);
+    }
+    const VertexId starts[2] = {from, to};
+    for (int side = 0; side < 2; ++side) {
+        reached[side][starts[side]] = true;
+        queues[side].push({side == 0 ? potential(from) : -potential(to), starts[side]});
+    }
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+    // Поиск останавливается, когда сумма минимальных ключей очередей не меньше лучшего пути
+    while (!queues[0].empty() && !queues[1].empty()) {
+        const double top_forward = queues[0].top().first;
+        const double top_backward = queues[1].top().first;
+        if (best_weight && top_forward + top_backward >= static_cast<double>(*best_weight)) {
+            break;
+        }
+        const int side = top_forward <= top_backward ? 0 : 1;
+        const auto [key, vertex] = queues[side].top();
+        queues[side].pop();
+        const double sign = side == 0 ? 1.0 : -1.0;
+        if (key > static_cast<double>(weights[side][vertex]) + sign * potential(vertex)) {
+            continue;
+        }
+
+        for (const auto& edge : side == 0 ? graph_.GetOutgoingEdges(vertex) : graph_.GetIncomingEdges(vertex)) {
+            const VertexId next = edge.vertex;
+            const Weight candidate_weight = weights[side][vertex] + edge.weight;
+            if (!reached[side][next] || candidate_weight < weights[side][next]) {
+                reached[side][next] = true;
+                weights[side][next] = candidate_weight;
+                parents[side][next] = edge.id;
+                queues[side].push({static_cast<double>(candidate_weight) + sign * potential(next), next});
+            }
+            if (reached[1 - side][next]) {
+                const Weight route_weight = weights[side][next] + weights[1 - side][next];
+                if (!best_weight || route_weight < *best_weight) {
+                    best_weight = route_weight;
+                    meeting_vertex = next;
+                }
+            }
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (VertexId vertex = meeting_vertex; parents[0][vertex] != NO_EDGE; vertex = graph_.GetEdge(parents[0][vertex]).from) {
+        edges.push_back(parents[0][vertex]);
+    }
+    std::reverse(edges.begin(), edges.end());
+    for (VertexId vertex = meeting_vertex; parents[1][vertex] != NO_EDGE; vertex = graph_.GetEdge(parents[1][vertex]).to) {
+        edges.push_back(parents[1][vertex]);
+    }
+
+    return RouteInfo{*best_weight, std::move(edges)};
+}
+
+}  // namespace graph
@@ -0,0 +1,338 @@
+#pragma once
+
+#include "graph.h"
+#include "route_engine.h"
+#include "thread_pool.h"
+#include "weight_traits.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace graph {
+
+namespace detail {
+
+// Ядро min-plus: для j из [0, count) weights_ij[j] = min(weights_ij[j], weight_ik + weights_kj[j]).
+// Обновление только при строгом улучшении - так же, как в Router, поэтому при равных весах
+// сохраняется ранее найденный путь. Для целочисленных весов сумма с бесконечностью не переполняется.
+// PrevEdge - EdgeId или 32-битный номер ребра компактной таблицы
+template <typename Weight, typename PrevEdge>
+void RelaxRowMinPlus(Weight weight_ik, const Weight* weights_kj, const PrevEdge* prev_edges_kj,
+                     Weight* weights_ij, PrevEdge* prev_edges_ij, size_t count) {
+    for (size_t j = 0; j < count; ++j) {
+        const Weight candidate_weight = WeightTraits<Weight>::Add(weight_ik, weights_kj[j]);
+        if (candidate_weight < weights_ij[j]) {
+            weights_ij[j] = candidate_weight;
+            prev_edges_ij[j] = prev_edges_kj[j];
+        }
+    }
+}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+static_assert(sizeof(EdgeId) == sizeof(double), "SIMD kernel blends 64-bit edge ids as doubles");
+
+inline void RelaxRowMinPlus(double weight_ik, const double* weights_kj, const EdgeId* prev_edges_kj,
+                            double* weights_ij, EdgeId* prev_edges_ij, size_t count) {
+    size_t j = 0;
+#if defined(__AVX2__)
+    const __m256d ik = _mm256_set1_pd(weight_ik);
+    for (; j + 4 <= count; j += 4) {
+        const __m256d candidate = _mm256_add_pd(ik, _mm256_loadu_pd(weights_kj + j));
+        const __m256d current = _mm256_loadu_pd(weights_ij + j);
+        const __m256d mask = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+        _mm256_storeu_pd(weights_ij + j, _mm256_blendv_pd(current, candidate, mask));
+
+        const __m256d prev_kj = _mm256_castsi256_pd(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges_kj + j)));
+        const __m256d prev_ij = _mm256_castsi256_pd(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges_ij + j)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(prev_edges_ij + j),
+                            _mm256_castpd_si256(_mm256_blendv_pd(prev_ij, prev_kj, mask)));
+    }
+#else
+    const __m128d ik = _mm_set1_pd(weight_ik);
+    for (; j + 2 <= count; j += 2) {
+        const __m128d candidate = _mm_add_pd(ik, _mm_loadu_pd(weights_kj + j));
+        const __m128d current = _mm_loadu_pd(weights_ij + j);
+        const __m128d mask = _mm_cmplt_pd(candidate, current);
+        _mm_storeu_pd(weights_ij + j, _mm_or_pd(_mm_and_pd(mask, candidate), _mm_andnot_pd(mask, current)));
+
+        const __m128i mask_bits = _mm_castpd_si128(mask);
+        const __m128i prev_kj = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_kj + j));
+        const __m128i prev_ij = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_ij + j));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(prev_edges_ij + j),
+                         _mm_or_si128(_mm_and_si128(mask_bits, prev_kj), _mm_andnot_si128(mask_bits, prev_ij)));
+    }
+#endif
+    for (; j < count; ++j) {
+        const double candidate_weight = weight_ik + weights_kj[j];
+        if (candidate_weight < weights_ij[j]) {
+            weights_ij[j] = candidate_weight;
+            prev_edges_ij[j] = prev_edges_kj[j];
+        }
+    }
+}
+
+// То же для 32-битных номеров ребер: маска сравнения пар double сжимается до 32-битных элементов
+inline void RelaxRowMinPlus(double weight_ik, const double* weights_kj, const uint32_t* prev_edges_kj,
+                            double* weights_ij, uint32_t* prev_edges_ij, size_t count) {
+    size_t j = 0;
+#if defined(__AVX2__)
+    const __m256d ik = _mm256_set1_pd(weight_ik);
+    const __m256i low_halves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    for (; j + 4 <= count; j += 4) {
+        const __m256d candidate = _mm256_add_pd(ik, _mm256_loadu_pd(weights_kj + j));
+        const __m256d current = _mm256_loadu_pd(weights_ij + j);
+        const __m256d mask = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+        _mm256_storeu_pd(weights_ij + j, _mm256_blendv_pd(current, candidate, mask));
+
+        const __m128i mask_bits = _mm256_castsi256_si128(
+            _mm256_permutevar8x32_epi32(_mm256_castpd_si256(mask), low_halves));
+        const __m128i prev_kj = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_kj + j));
+        const __m128i prev_ij = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_ij + j));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(prev_edges_ij + j), _mm_blendv_epi8(prev_ij, prev_kj, mask_bits));
+    }
+#else
+    const __m128d ik = _mm_set1_pd(weight_ik);
+    for (; j + 2 <= count; j += 2) {
+        const __m128d candidate = _mm_add_pd(ik, _mm_loadu_pd(weights_kj + j));
+        const __m128d current = _mm_loadu_pd(weights_ij + j);
+        const __m128d mask = _mm_cmplt_pd(candidate, current);
+        _mm_storeu_pd(weights_ij + j, _mm_or_pd(_mm_and_pd(mask, candidate), _mm_andnot_pd(mask, current)));
+
+        const __m128i mask_bits = _mm_shuffle_epi32(_mm_castpd_si128(mask), _MM_SHUFFLE(3, 3, 2, 0));
+        const __m128i prev_kj = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(prev_edges_kj + j));
+        const __m128i prev_ij = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(prev_edges_ij + j));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(prev_edges_ij + j),
+                         _mm_or_si128(_mm_and_si128(mask_bits, prev_kj), _mm_andnot_si128(mask_bits, prev_ij)));
+    }
+#endif
+    for (; j < count; ++j) {
+        const double candidate_weight = weight_ik + weights_kj[j];
+        if (candidate_weight < weights_ij[j]) {
+            weights_ij[j] = candidate_weight;
+            prev_edges_ij[j] = prev_edges_kj[j];
+        }
+    }
+}
+#endif
+
+// Блочный алгоритм Флойда-Уоршелла по плоским таблицам весов и последних ребер пути
+// (ячейка from * vertex_count + to), в которые уже записаны ребра графа.
+// Таблица разбита на квадратные блоки; на каждой фазе независимые блоки обрабатываются пулом потоков.
+// Шаг k обычного алгоритма читает строку k и столбец k до шагов k + 1, ..., а блок обрабатывает подряд
+// несколько шагов, поэтому строка и столбец каждого шага блока запоминаются (ведущие строки и столбцы)
+// и релаксации идут по ним. Каждая ячейка получает те же суммы в том же порядке, что в Router, поэтому
+// из равных по весу путей выбирается тот же. Результат не зависит от числа потоков
+template <typename Weight, typename PrevEdge>
+class BlockedFloydWarshall {
+public:
+    BlockedFloydWarshall(size_t vertex_count, size_t block_size, Weight* weights, PrevEdge* prev_edges)
+        : vertex_count_(vertex_count)
+        , block_size_(std::max<size_t>(block_size, 1))
+        , block_count_((vertex_count_ + block_size_ - 1) / block_size_)
+        , weights_(weights)
+        , prev_edges_(prev_edges)
+        , pivot_row_weights_(block_size_ * vertex_count_)
+        , pivot_row_prev_edges_(block_size_ * vertex_count_)
+        , pivot_column_weights_(vertex_count_ * block_size_) {
+    }
+
+    void Run(concurrency::ThreadPool& thread_pool);
+
+private:
+    static constexpr Weight INFINITE_WEIGHT = WeightTraits<Weight>::INFINITE;
+
+    // Шаги блока block_k для ячеек блока (block_i, block_j). Строки шагов для столбцов блока block_j
+    // запоминаются, если block_i == block_k, столбцы шагов для строк блока block_i - если block_j == block_k
+    void RelaxBlock(size_t block_i, size_t block_j, size_t block_k);
+
+    size_t Index(VertexId from, VertexId to) const {
+        return from * vertex_count_ + to;
+    }
+
+    const size_t vertex_count_;
+    const size_t block_size_;
+    const size_t block_count_;
+    Weight* const weights_;
+    PrevEdge* const prev_edges_;
+    std::vector<Weight> pivot_row_weights_;      // [шаг в блоке][to]: строка шага перед ним
+    std::vector<PrevEdge> pivot_row_prev_edges_;
+    std::vector<Weight> pivot_column_weights_;   // [from][шаг в блоке]: столбец шага перед ним
+};
+
+template <typename Weight, typename PrevEdge>
+void BlockedFloydWarshall<Weight, PrevEdge>::RelaxBlock(size_t block_i, size_t block_j, size_t block_k) {
+    const size_t i_begin = block_i * block_size_;
+    const size_t i_end = std::min(vertex_count_, i_begin + block_size_);
+    const size_t j_begin = block_j * block_size_;
+    const size_t j_count = std::min(vertex_count_, j_begin + block_size_) - j_begin;
+    const size_t k_begin = block_k * block_size_;
+    const size_t k_end = std::min(vertex_count_, k_begin + block_size_);
+
+    for (VertexId vertex_through = k_begin; vertex_through < k_end; ++vertex_through) {
+        const size_t step = vertex_through - k_begin;
+        Weight* weights_kj = &pivot_row_weights_[step * vertex_count_ + j_begin];
+        PrevEdge* prev_edges_kj = &pivot_row_prev_edges_[step * vertex_count_ + j_begin];
+        if (block_i == block_k) {
+            std::copy_n(weights_ + Index(vertex_through, j_begin), j_count, weights_kj);
+            std::copy_n(prev_edges_ + Index(vertex_through, j_begin), j_count, prev_edges_kj);
+        }
+        for (VertexId vertex_from = i_begin; vertex_from < i_end; ++vertex_from) {
+            Weight& weight_ik = pivot_column_weights_[vertex_from * block_size_ + step];
+            if (block_j == block_k) {
+                weight_ik = weights_[Index(vertex_from, vertex_through)];
+            }
+            if (weight_ik == INFINITE_WEIGHT) {
+                continue;
+            }
+            RelaxRowMinPlus(weight_ik, static_cast<const Weight*>(weights_kj), static_cast<const PrevEdge*>(prev_edges_kj),
+                            weights_ + Index(vertex_from, j_begin),
+                            prev_edges_ + Index(vertex_from, j_begin), j_count);
+        }
+    }
+}
+
+template <typename Weight, typename PrevEdge>
+void BlockedFloydWarshall<Weight, PrevEdge>::Run(concurrency::ThreadPool& thread_pool) {
+    for (size_t block_k = 0; block_k < block_count_; ++block_k) {
+        // Фаза 1: диагональный блок, запоминаются строки и столбцы шагов в его пределах
+        RelaxBlock(block_k, block_k, block_k);
+
+        // Фаза 2: блоки строки и столбца block_k зависят только от диагонального блока
+        // и дописывают ведущие строки и столбцы
+        thread_pool.ParallelFor(2 * block_count_, [this, block_k](size_t index) {
+            const size_t block = index / 2;
+            if (block == block_k) {
+                return;
+            }
+            if (index % 2 == 0) {
+                RelaxBlock(block_k, block, block_k);
+            } else {
+                RelaxBlock(block, block_k, block_k);
+            }
+        });
+
+        // Фаза 3: остальные блоки читают только ведущие строки и столбцы
+        thread_pool.ParallelFor(block_count_, [this, block_k](size_t block_i) {
+            if (block_i == block_k) {
+                return;
+            }
+            for (size_t block_j = 0; block_j < block_count_; ++block_j) {
+                if (block_j != block_k) {
+                    RelaxBlock(block_i, block_j, block_k);
+                }
+            }
+        });
+    }
+}
+
+}  // namespace detail
+
+// Предрасчет всех пар вершин блочным алгоритмом Флойда-Уоршелла (detail::BlockedFloydWarshall).
+// Таблица хранится в плоских массивах: вес и последнее ребро пути для каждой пары
+template <typename Weight>
+class BlockedRouter : public RouteEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouteEngine<Weight>::RouteInfo;
+
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64;
+
+    // thread_count == 0 - по числу аппаратных потоков
+    explicit BlockedRouter(const Graph& graph, size_t thread_count = 0, size_t block_size = DEFAULT_BLOCK_SIZE);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    std::optional<Weight> BuildRouteEdges(VertexId from, VertexId to, std::vector<EdgeId>& edges) const override;
+
+private:
+    static constexpr Weight ZERO_WEIGHT = WeightTraits<Weight>::ZERO;
+    static constexpr Weight INFINITE_WEIGHT = WeightTraits<Weight>::INFINITE;
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    void InitializeRoutesInternalData();
+
+    size_t Index(VertexId from, VertexId to) const {
+        return from * vertex_count_ + to;
+    }
+
+    const Graph& graph_;
+    const size_t vertex_count_;
+    std::vector<Weight> weights_;
+    std::vector<EdgeId> prev_edges_;
+};
+
+template <typename Weight>
+BlockedRouter<Weight>::BlockedRouter(const Graph& graph, size_t thread_count, size_t block_size)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+    , weights_(vertex_count_ * vertex_count_, INFINITE_WEIGHT)
+    , prev_edges_(vertex_count_ * vertex_count_, NO_EDGE)
+{
+    InitializeRoutesInternalData();
+    concurrency::ThreadPool thread_pool(thread_count);
+    detail::BlockedFloydWarshall<Weight, EdgeId>(vertex_count_, block_size, weights_.data(), prev_edges_.data())
+        .Run(thread_pool);
+}
+
+template <typename Weight>
+void BlockedRouter<Weight>::InitializeRoutesInternalData() {
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        weights_[Index(vertex, vertex)] = ZERO_WEIGHT;
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            const size_t index = Index(vertex, edge.to);
+            if (edge.to != vertex && weights_[index] > edge.weight) {
+                weights_[index] = edge.weight;
+                prev_edges_[index] = edge_id;
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename BlockedRouter<Weight>::RouteInfo> BlockedRouter<Weight>::BuildRoute(VertexId from,
+                                                                                           VertexId to) const {
+    std::vector<EdgeId> edges;
+    const auto weight = BuildRouteEdges(from, to, edges);
+    if (!weight) {
+        return std::nullopt;
+    }
+    return RouteInfo{*weight, std::move(edges)};
+}
+
+template <typename Weight>
+std::optional<Weight> BlockedRouter<Weight>::BuildRouteEdges(VertexId from, VertexId to, std::vector<EdgeId>& edges) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const Weight weight = weights_[Index(from, to)];
+    if (weight == INFINITE_WEIGHT) {
+        return std::nullopt;
+    }
+    edges.clear();
+    for (EdgeId edge_id = prev_edges_[Index(from, to)];
+         edge_id != NO_EDGE;
+         edge_id = prev_edges_[Index(from, graph_.GetEdge(edge_id).from)])
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    return weight;
+}
+
+}  // namespace graph
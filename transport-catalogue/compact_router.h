@@ -0,0 +1,160 @@
+#pragma once
+
+#include "blocked_router.h"
+#include "csr_graph.h"
+#include "graph.h"
+#include "route_engine.h"
+#include "thread_pool.h"
+#include "weight_traits.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Ячейка компактной таблицы: округленный вес пути и последнее ребро пути.
+// Тривиально копируемая, поэтому таблицу можно записать в файл и читать отображенной в память
+struct CompactRouteCell {
+    float weight;
+    uint32_t prev_edge;
+};
+
+// Предрасчет всех пар вершин в компактной таблице: одно непрерывное выделение памяти,
+// ячейка - вес float и 32-битное последнее ребро пути (8 байт против 32 у Router).
+// Таблица считается блочным Флойдом-Уоршеллом в типе Weight, как в BlockedRouter, поэтому из равных
+// по весу путей выбирается тот же; в ячейки попадают только округленный вес и ребро (на время
+// построения нужны еще веса в типе Weight). Вес маршрута при восстановлении суммируется
+// по исходным ребрам, поэтому совпадает с весом, найденным в типе Weight
+template <typename Weight>
+class CompactRouter : public RouteEngine<Weight> {
+private:
+    using Graph = CsrGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouteEngine<Weight>::RouteInfo;
+
+    // thread_count == 0 - по числу аппаратных потоков
+    explicit CompactRouter(const Graph& graph, size_t thread_count = 0);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    std::optional<Weight> BuildRouteEdges(VertexId from, VertexId to, std::vector<EdgeId>& edges) const override;
+    bool UpdateGraph(const GraphDiff<Weight>& diff) override;
+
+    // Таблица по строкам: ячейка from * GetVertexCount() + to
+    const std::vector<CompactRouteCell>& GetRouteCells() const {
+        return routes_;
+    }
+
+    static constexpr float UNREACHABLE = std::numeric_limits<float>::infinity();
+    static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+private:
+    using CompactEdgeId = uint32_t;
+    using RouteCell = CompactRouteCell;
+
+    static constexpr Weight ZERO_WEIGHT = WeightTraits<Weight>::ZERO;
+    static constexpr Weight INFINITE_WEIGHT = WeightTraits<Weight>::INFINITE;
+
+    void ComputeTable();
+
+    const Graph& graph_;
+    const size_t vertex_count_;
+    const size_t thread_count_;
+    std::vector<RouteCell> routes_;  // routes_[from * vertex_count_ + to]
+};
+
+template <typename Weight>
+CompactRouter<Weight>::CompactRouter(const Graph& graph, size_t thread_count)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+    , thread_count_(thread_count)
+{
+    if (graph.GetEdgeCount() >= NO_EDGE) {
+        throw std::length_error("Too many edges for 32-bit edge ids");
+    }
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+
+    ComputeTable();
+}
+
+template <typename Weight>
+void CompactRouter<Weight>::ComputeTable() {
+    std::vector<Weight> weights(vertex_count_ * vertex_count_, INFINITE_WEIGHT);
+    std::vector<CompactEdgeId> prev_edges(vertex_count_ * vertex_count_, NO_EDGE);
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        weights[vertex * vertex_count_ + vertex] = ZERO_WEIGHT;
+        for (const auto& edge : graph_.GetOutgoingEdges(vertex)) {
+            const size_t index = vertex * vertex_count_ + edge.vertex;
+            if (edge.vertex != vertex && weights[index] > edge.weight) {
+                weights[index] = edge.weight;
+                prev_edges[index] = static_cast<CompactEdgeId>(edge.id);
+            }
+        }
+    }
+    concurrency::ThreadPool pool(thread_count_);
+    detail::BlockedFloydWarshall<Weight, CompactEdgeId>(vertex_count_, BlockedRouter<Weight>::DEFAULT_BLOCK_SIZE,
+                                                        weights.data(), prev_edges.data())
+        .Run(pool);
+
+    routes_.assign(vertex_count_ * vertex_count_, RouteCell{UNREACHABLE, NO_EDGE});
+    for (size_t index = 0; index < routes_.size(); ++index) {
+        if (weights[index] != INFINITE_WEIGHT) {
+            routes_[index] = RouteCell{static_cast<float>(weights[index]), prev_edges[index]};
+        }
+    }
+}
+
+// Путь, выбранный из равных по весу, зависит от всей таблицы, поэтому после изменений она считается заново
+// на месте; номера ребер берутся из нового графа
+template <typename Weight>
+bool CompactRouter<Weight>::UpdateGraph(const GraphDiff<Weight>& /*diff*/) {
+    if (graph_.GetVertexCount() != vertex_count_ || graph_.GetEdgeCount() >= NO_EDGE) {
+        return false;
+    }
+    ComputeTable();
+    return true;
+}
+
+template <typename Weight>
+std::optional<typename CompactRouter<Weight>::RouteInfo> CompactRouter<Weight>::BuildRoute(VertexId from,
+                                                                                           VertexId to) const {
+    std::vector<EdgeId> edges;
+    const auto weight = BuildRouteEdges(from, to, edges);
+    if (!weight) {
+        return std::nullopt;
+    }
+    return RouteInfo{*weight, std::move(edges)};
+}
+
+template <typename Weight>
+std::optional<Weight> CompactRouter<Weight>::BuildRouteEdges(VertexId from, VertexId to, std::vector<EdgeId>& edges) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const RouteCell* row = routes_.data() + from * vertex_count_;
+    if (row[to].weight == UNREACHABLE) {
+        return std::nullopt;
+    }
+    edges.clear();
+    for (CompactEdgeId edge_id = row[to].prev_edge; edge_id != NO_EDGE; edge_id = row[graph_.GetEdge(edge_id).from].prev_edge) {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        weight += graph_.GetEdge(edge_id).weight;
+    }
+    return weight;
+}
+
+}  // namespace graph
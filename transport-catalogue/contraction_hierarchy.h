@@ -0,0 +1,441 @@
+#pragma once
+
+#include "csr_graph.h"
+#include "graph.h"
+#include "route_engine.h"
+#include "weight_traits.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Маршрутизатор на основе иерархий сжатия (Contraction Hierarchies).
+// При построении вершины упорядочиваются по важности и по очереди стягиваются, а кратчайшие пути
+// через стянутую вершину заменяются ребрами-сокращениями. Сокращение помнит пару ребер, из которых
+// оно составлено, поэтому найденный путь раскрывается до исходных ребер графа.
+// Запрос - двунаправленный поиск Дейкстры только по ребрам, ведущим к более важным вершинам
+template <typename Weight>
+class ContractionHierarchy : public RouteEngine<Weight> {
+private:
+    using Graph = CsrGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouteEngine<Weight>::RouteInfo;
+
+    explicit ContractionHierarchy(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    size_t GetShortcutCount() const {
+        return edges_.size() - original_edge_count_;
+    }
+
+private:
+    using ChEdgeId = uint32_t;
+    static constexpr ChEdgeId NO_CH_EDGE = std::numeric_limits<ChEdgeId>::max();
+    static constexpr Weight ZERO_WEIGHT = WeightTraits<Weight>::ZERO;
+    static constexpr Weight MAX_WEIGHT = std::numeric_limits<Weight>::max();
+    // Ограничения локального поиска свидетелей: если свидетель не найден за это число
+    // просмотренных вершин, сокращение добавляется (лишнее сокращение не нарушает корректность).
+    // При оценке приоритета достаточно более грубого поиска
+    static constexpr size_t WITNESS_SEARCH_LIMIT = 500;
+    static constexpr size_t SIMULATION_WITNESS_SEARCH_LIMIT = 50;
+
+    struct ChEdge {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId original_edge;   // для ребер исходного графа
+        ChEdgeId first_child;   // для сокращений: ребра from -> середина -> to
+        ChEdgeId second_child;
+
+        bool IsShortcut() const {
+            return first_child != NO_CH_EDGE;
+        }
+    };
+
+    struct UpwardEdge {
+        VertexId to;
+        Weight weight;
+        ChEdgeId ch_edge;
+    };
+
+    // Рабочее состояние, нужное только во время построения
+    struct ContractionState {
+        std::vector<std::vector<ChEdgeId>> out_edges;
+        std::vector<std::vector<ChEdgeId>> in_edges;
+        std::vector<bool> contracted;
+        std::vector<int> contracted_neighbors;
+        std::vector<Weight> witness_weights;
+        std::vector<VertexId> witness_touched;
+        std::vector<bool> witness_targets;
+    };
+
+    void InitializeEdges(const Graph& graph, ContractionState& state);
+    void ContractAll(ContractionState& state);
+    void RemoveContractedVertex(VertexId vertex, ContractionState& state);
+    int ComputePriority(VertexId vertex, ContractionState& state);
+    size_t ContractVertex(VertexId vertex, ContractionState& state, bool simulate);
+    void RunWitnessSearch(VertexId source, VertexId excluded, Weight max_weight, size_t target_count,
+                          size_t settled_limit, ContractionState& state) const;
+    void AddOrUpdateShortcut(ChEdgeId in_edge, ChEdgeId out_edge, Weight weight, ContractionState& state);
+    void BuildUpwardGraphs();
+    void UnpackEdge(ChEdgeId ch_edge, std::vector<EdgeId>& edges) const;
+
+    size_t vertex_count_ = 0;
+    size_t original_edge_count_ = 0;
+    std::vector<ChEdge> edges_;
+    std::vector<size_t> rank_;
+
+    // Восходящие ребра в формате CSR: прямой поиск идет по forward_, обратный - по backward_
+    std::vector<size_t> forward_offsets_;
+    std::vector<UpwardEdge> forward_;
+    std::vector<size_t> backward_offsets_;
+    std::vector<UpwardEdge> backward_;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+    : vertex_count_(graph.GetVertexCount())
+    , rank_(graph.GetVertexCount())
+{
+    ContractionState state;
+    InitializeEdges(graph, state);
+    ContractAll(state);
+    BuildUpwardGraphs();
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::InitializeEdges(const Graph& graph, ContractionState& state) {
+    state.out_edges.resize(vertex_count_);
+    state.in_edges.resize(vertex_count_);
+    state.contracted.assign(vertex_count_, false);
+    state.contracted_neighbors.assign(vertex_count_, 0);
+    state.witness_weights.assign(vertex_count_, MAX_WEIGHT);
+    state.witness_targets.assign(vertex_count_, false);
+
+    // Петли не участвуют в кратчайших путях, из параллельных ребер остается самое легкое
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        for (const auto& edge : graph.GetOutgoingEdges(vertex)) {
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            if (edge.vertex == vertex) {
+                continue;
+            }
+            auto parallel = std::find_if(state.out_edges[vertex].begin(), state.out_edges[vertex].end(),
+                                         [this, &edge](ChEdgeId id) { return edges_[id].to == edge.vertex; });
+            if (parallel != state.out_edges[vertex].end()) {
+                if (edge.weight < edges_[*parallel].weight) {
+                    edges_[*parallel].weight = edge.weight;
+                    edges_[*parallel].original_edge = edge.id;
+                }
+                continue;
+            }
+            const auto id = static_cast<ChEdgeId>(edges_.size());
+            edges_.push_back({vertex, edge.vertex, edge.weight, edge.id, NO_CH_EDGE, NO_CH_EDGE});
+            state.out_edges[vertex].push_back(id);
+            state.in_edges[edge.vertex].push_back(id);
+        }
+    }
+    original_edge_count_ = edges_.size();
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::ContractAll(ContractionState& state) {
+    using QueueItem = std::pair<int, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        queue.push({ComputePriority(vertex, state), vertex});
+    }
+
+    // Ленивое обновление: приоритет пересчитывается при извлечении, и если вершина
+    // перестала быть наименее важной, она возвращается в очередь
+    size_t next_rank = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+        const int priority = ComputePriority(vertex, state);
+        if (!queue.empty() && priority > queue.top().first) {
+            queue.push({priority, vertex});
+            continue;
+        }
+        ContractVertex(vertex, state, false);
+        state.contracted[vertex] = true;
+        rank_[vertex] = next_rank++;
+        RemoveContractedVertex(vertex, state);
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::RemoveContractedVertex(VertexId vertex, ContractionState& state) {
+    // Ребра стянутой вершины остаются в edges_, но исключаются из списков соседей,
+    // чтобы поиск свидетелей не просматривал их повторно
+    const auto is_incident = [this, vertex](ChEdgeId id) {
+        return edges_[id].from == vertex || edges_[id].to == vertex;
+    };
+    for (const ChEdgeId id : state.out_edges[vertex]) {
+        auto& neighbor_in_edges = state.in_edges[edges_[id].to];
+        neighbor_in_edges.erase(std::remove_if(neighbor_in_edges.begin(), neighbor_in_edges.end(), is_incident),
+                                neighbor_in_edges.end());
+        ++state.contracted_neighbors[edges_[id].to];
+    }
+    for (const ChEdgeId id : state.in_edges[vertex]) {
+        auto& neighbor_out_edges = state.out_edges[edges_[id].from];
+        neighbor_out_edges.erase(std::remove_if(neighbor_out_edges.begin(), neighbor_out_edges.end(), is_incident),
+                                 neighbor_out_edges.end());
+        ++state.contracted_neighbors[edges_[id].from];
+    }
+    state.out_edges[vertex].clear();
+    state.out_edges[vertex].shrink_to_fit();
+    state.in_edges[vertex].clear();
+    state.in_edges[vertex].shrink_to_fit();
+}
+
+template <typename Weight>
+int ContractionHierarchy<Weight>::ComputePriority(VertexId vertex, ContractionState& state) {
+    const size_t shortcuts = ContractVertex(vertex, state, true);
+    const size_t removed_edges = state.out_edges[vertex].size() + state.in_edges[vertex].size();
+    return static_cast<int>(shortcuts) - static_cast<int>(removed_edges) + state.contracted_neighbors[vertex];
+}
+
+template <typename Weight>
+size_t ContractionHierarchy<Weight>::ContractVertex(VertexId vertex, ContractionState& state, bool simulate) {
+    size_t shortcut_count = 0;
+    // Копия: при добавлении сокращений списки соседей могут расти
+    const std::vector<ChEdgeId> in_edges = state.in_edges[vertex];
+    const std::vector<ChEdgeId> out_edges = state.out_edges[vertex];
+
+    for (const ChEdgeId in_edge : in_edges) {
+        const VertexId source = edges_[in_edge].from;
+        if (state.contracted[source]) {
+            continue;
+        }
+        Weight max_weight = ZERO_WEIGHT;
+        size_t target_count = 0;
+        for (const ChEdgeId out_edge : out_edges) {
+            const VertexId target = edges_[out_edge].to;
+            if (!state.contracted[target] && target != source) {
+                max_weight = std::max(max_weight, edges_[in_edge].weight + edges_[out_edge].weight);
+                if (!state.witness_targets[target]) {
+                    state.witness_targets[target] = true;
+                    ++target_count;
+                }
+            }
+        }
+        RunWitnessSearch(source, vertex, max_weight, target_count,
+                         simulate ? SIMULATION_WITNESS_SEARCH_LIMIT : WITNESS_SEARCH_LIMIT, state);
+        for (const ChEdgeId out_edge : out_edges) {
+            state.witness_targets[edges_[out_edge].to] = false;
+        }
+
+        for (const ChEdgeId out_edge : out_edges) {
+            const VertexId target = edges_[out_edge].to;
+            if (state.contracted[target] || target == source) {
+                continue;
+            }
+            const Weight via_weight = edges_[in_edge].weight + edges_[out_edge].weight;
+            if (state.witness_weights[target] <= via_weight) {
+                continue;
+            }
+            ++shortcut_count;
+            if (!simulate) {
+                AddOrUpdateShortcut(in_edge, out_edge, via_weight, state);
+            }
+        }
+    }
+    return shortcut_count;
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::RunWitnessSearch(VertexId source, VertexId excluded, Weight max_weight,
+                                                    size_t target_count, size_t settled_limit,
+                                                    ContractionState& state) const {
+    using QueueItem = std::pair<Weight, VertexId>;
+
+    for (const VertexId vertex : state.witness_touched) {
+        state.witness_weights[vertex] = MAX_WEIGHT;
+    }
+    state.witness_touched.clear();
+
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    state.witness_weights[source] = ZERO_WEIGHT;
+    state.witness_touched.push_back(source);
+    queue.push({ZERO_WEIGHT, source});
+
+    size_t settled_count = 0;
+    while (!queue.empty() && settled_count < settled_limit && target_count != 0) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (state.witness_weights[vertex] < weight) {
+            continue;
+        }
+        if (weight > max_weight) {
+            break;
+        }
+        ++settled_count;
+        if (state.witness_targets[vertex]) {
+            --target_count;
+        }
+        for (const ChEdgeId id : state.out_edges[vertex]) {
+            const auto& edge = edges_[id];
+            if (edge.to == excluded || state.contracted[edge.to]) {
+                continue;
+            }
+            const Weight candidate_weight = weight + edge.weight;
+            if (candidate_weight < state.witness_weights[edge.to]) {
+                if (state.witness_weights[edge.to] == MAX_WEIGHT) {
+                    state.witness_touched.push_back(edge.to);
+                }
+                state.witness_weights[edge.to] = candidate_weight;
+                queue.push({candidate_weight, edge.to});
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::AddOrUpdateShortcut(ChEdgeId in_edge, ChEdgeId out_edge, Weight weight,
+                                                       ContractionState& state) {
+    const VertexId from = edges_[in_edge].from;
+    const VertexId to = edges_[out_edge].to;
+
+    // Ребро между двумя еще не стянутыми вершинами не входит ни в одно сокращение,
+    // поэтому его можно заменить более коротким сокращением на месте
+    auto existing = std::find_if(state.out_edges[from].begin(), state.out_edges[from].end(),
+                                 [this, to](ChEdgeId id) { return edges_[id].to == to; });
+    if (existing != state.out_edges[from].end()) {
+        if (weight < edges_[*existing].weight) {
+            edges_[*existing].weight = weight;
+            edges_[*existing].first_child = in_edge;
+            edges_[*existing].second_child = out_edge;
+        }
+        return;
+    }
+    const auto id = static_cast<ChEdgeId>(edges_.size());
+    edges_.push_back({from, to, weight, 0, in_edge, out_edge});
+    state.out_edges[from].push_back(id);
+    state.in_edges[to].push_back(id);
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildUpwardGraphs() {
+    forward_offsets_.assign(vertex_count_ + 1, 0);
+    backward_offsets_.assign(vertex_count_ + 1, 0);
+    for (const auto& edge : edges_) {
+        if (rank_[edge.from] < rank_[edge.to]) {
+            ++forward_offsets_[edge.from + 1];
+        } else {
+            ++backward_offsets_[edge.to + 1];
+        }
+    }
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        forward_offsets_[vertex + 1] += forward_offsets_[vertex];
+        backward_offsets_[vertex + 1] += backward_offsets_[vertex];
+    }
+
+    forward_.resize(forward_offsets_.back());
+    backward_.resize(backward_offsets_.back());
+    std::vector<size_t> forward_pos(forward_offsets_.begin(), forward_offsets_.end() - 1);
+    std::vector<size_t> backward_pos(backward_offsets_.begin(), backward_offsets_.end() - 1);
+    for (ChEdgeId id = 0; id < edges_.size(); ++id) {
+        const auto& edge = edges_[id];
+        if (rank_[edge.from] < rank_[edge.to]) {
+            forward_[forward_pos[edge.from]++] = {edge.to, edge.weight, id};
+        } else {
+            backward_[backward_pos[edge.to]++] = {edge.from, edge.weight, id};
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo> ContractionHierarchy<Weight>::BuildRoute(
+    VertexId from, VertexId to) const {
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    std::vector<Weight> weights[2] = {std::vector<Weight>(vertex_count_, MAX_WEIGHT),
+                                      std::vector<Weight>(vertex_count_, MAX_WEIGHT)};
+    std::vector<ChEdgeId> parents[2] = {std::vector<ChEdgeId>(vertex_count_, NO_CH_EDGE),
+                                        std::vector<ChEdgeId>(vertex_count_, NO_CH_EDGE)};
+    const std::vector<size_t>* offsets[2] = {&forward_offsets_, &backward_offsets_};
+    const std::vector<UpwardEdge>* upward[2] = {&forward_, &backward_};
+    Queue queues[2];
+
+    weights[0][from] = ZERO_WEIGHT;
+    weights[1][to] = ZERO_WEIGHT;
+    queues[0].push({ZERO_WEIGHT, from});
+    queues[1].push({ZERO_WEIGHT, to});
+
+    Weight best_weight = MAX_WEIGHT;
+    std::optional<VertexId> meeting_vertex;
+    for (;;) {
+        const Weight top_forward = queues[0].empty() ? MAX_WEIGHT : queues[0].top().first;
+        const Weight top_backward = queues[1].empty() ? MAX_WEIGHT : queues[1].top().first;
+        if (std::min(top_forward, top_backward) >= best_weight || (queues[0].empty() && queues[1].empty())) {
+            break;
+        }
+        const int side = top_forward <= top_backward ? 0 : 1;
+        const auto [weight, vertex] = queues[side].top();
+        queues[side].pop();
+        if (weights[side][vertex] < weight) {
+            continue;
+        }
+        if (weights[1 - side][vertex] != MAX_WEIGHT && weight + weights[1 - side][vertex] < best_weight) {
+            best_weight = weight + weights[1 - side][vertex];
+            meeting_vertex = vertex;
+        }
+        for (size_t i = (*offsets[side])[vertex]; i < (*offsets[side])[vertex + 1]; ++i) {
+            const auto& edge = (*upward[side])[i];
+            const Weight candidate_weight = weight + edge.weight;
+            if (candidate_weight < weights[side][edge.to]) {
+                weights[side][edge.to] = candidate_weight;
+                parents[side][edge.to] = edge.ch_edge;
+                queues[side].push({candidate_weight, edge.to});
+            }
+        }
+    }
+
+    if (!meeting_vertex) {
+        return std::nullopt;
+    }
+
+    std::vector<ChEdgeId> forward_path;
+    for (VertexId vertex = *meeting_vertex; parents[0][vertex] != NO_CH_EDGE; vertex = edges_[parents[0][vertex]].from) {
+        forward_path.push_back(parents[0][vertex]);
+    }
+    std::vector<EdgeId> edges;
+    for (auto it = forward_path.rbegin(); it != forward_path.rend(); ++it) {
+        UnpackEdge(*it, edges);
+    }
+    for (VertexId vertex = *meeting_vertex; parents[1][vertex] != NO_CH_EDGE; vertex = edges_[parents[1][vertex]].to) {
+        UnpackEdge(parents[1][vertex], edges);
+    }
+
+    return RouteInfo{best_weight, std::move(edges)};
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackEdge(ChEdgeId ch_edge, std::vector<EdgeId>& edges) const {
+    const auto& edge = edges_[ch_edge];
+    if (!edge.IsShortcut()) {
+        edges.push_back(edge.original_edge);
+        return;
+    }
+    UnpackEdge(edge.first_child, edges);
+    UnpackEdge(edge.second_child, edges);
+}
+
+}  // namespace graph
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "graph.h"
+#include "ranges.h"
+
+#include <vector>
+
+namespace graph {
+
+// Неизменяемое представление графа в формате CSR (compressed sparse row).
+// Исходящие и входящие ребра каждой вершины лежат в непрерывных массивах вместе с вершиной
+// на другом конце и весом, поэтому обход соседей не требует обращения к списку ребер.
+// Идентификаторы ребер совпадают с идентификаторами исходного DirectedWeightedGraph
+template <typename Weight>
+class CsrGraph {
+public:
+    struct IncidentEdge {
+        VertexId vertex;  // конец ребра для исходящих, начало - для входящих
+        Weight weight;
+        EdgeId id;
+    };
+
+private:
+    using IncidentEdgesRange = ranges_graph::Range<const IncidentEdge*>;
+
+public:
+    CsrGraph() = default;
+    explicit CsrGraph(const DirectedWeightedGraph<Weight>& graph);
+
+    size_t GetVertexCount() const;
+    size_t GetEdgeCount() const;
+    const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+    IncidentEdgesRange GetOutgoingEdges(VertexId vertex) const;
+    IncidentEdgesRange GetIncomingEdges(VertexId vertex) const;
+
+private:
+    std::vector<Edge<Weight>> edges_;
+    std::vector<size_t> outgoing_offsets_;
+    std::vector<IncidentEdge> outgoing_;
+    std::vector<size_t> incoming_offsets_;
+    std::vector<IncidentEdge> incoming_;
+};
+
+template <typename Weight>
+CsrGraph<Weight>::CsrGraph(const DirectedWeightedGraph<Weight>& graph)
+    : outgoing_offsets_(graph.GetVertexCount() + 1)
+    , incoming_offsets_(graph.GetVertexCount() + 1)
+{
+    const size_t vertex_count = graph.GetVertexCount();
+    const size_t edge_count = graph.GetEdgeCount();
+    edges_.reserve(edge_count);
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        edges_.push_back(edge);
+        ++outgoing_offsets_[edge.from + 1];
+        ++incoming_offsets_[edge.to + 1];
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        outgoing_offsets_[vertex + 1] += outgoing_offsets_[vertex];
+        incoming_offsets_[vertex + 1] += incoming_offsets_[vertex];
+    }
+
+    // Исходящие ребра сохраняют порядок списков инцидентности исходного графа
+    outgoing_.resize(edge_count);
+    incoming_.resize(edge_count);
+    std::vector<size_t> incoming_pos(incoming_offsets_.begin(), incoming_offsets_.end() - 1);
+    size_t outgoing_pos = 0;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = edges_[edge_id];
+            outgoing_[outgoing_pos++] = {edge.to, edge.weight, edge_id};
+        }
+    }
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        const auto& edge = edges_[edge_id];
+        incoming_[incoming_pos[edge.to]++] = {edge.from, edge.weight, edge_id};
+    }
+}
+
+template <typename Weight>
+size_t CsrGraph<Weight>::GetVertexCount() const {
+    return outgoing_offsets_.empty() ? 0 : outgoing_offsets_.size() - 1;
+}
+
+template <typename Weight>
+size_t CsrGraph<Weight>::GetEdgeCount() const {
+    return edges_.size();
+}
+
+template <typename Weight>
+const Edge<Weight>& CsrGraph<Weight>::GetEdge(EdgeId edge_id) const {
+    return edges_[edge_id];
+}
+
+template <typename Weight>
+typename CsrGraph<Weight>::IncidentEdgesRange CsrGraph<Weight>::GetOutgoingEdges(VertexId vertex) const {
+    return {outgoing_.data() + outgoing_offsets_[vertex], outgoing_.data() + outgoing_offsets_[vertex + 1]};
+}
+
+template <typename Weight>
+typename CsrGraph<Weight>::IncidentEdgesRange CsrGraph<Weight>::GetIncomingEdges(VertexId vertex) const {
+    return {incoming_.data() + incoming_offsets_[vertex], incoming_.data() + incoming_offsets_[vertex + 1]};
+}
+
+}  // namespace graph
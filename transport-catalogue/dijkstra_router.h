@@ -0,0 +1,397 @@
+#pragma once
+
+#include "csr_graph.h"
+#include "graph.h"
+#include "route_engine.h"
+#include "weight_traits.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Маршрутизатор без предварительного расчета всех пар вершин:
+// дерево кратчайших путей из вершины строится алгоритмом Дейкстры при первом запросе
+// и кешируется для последующих запросов из той же вершины. Вершина дерева - вес пути и 32-битное
+// последнее ребро (как ячейка CompactRouter), поэтому дерево занимает V * 16 байт для double и V * 8 для
+// целых весов. Из равных по весу путей выбирается тот же, что у Router (Флойда-Уоршелла); для вещественных
+// весов - если выбор не решает последний знак округления суммы (см. CompareRouterPaths)
+template <typename Weight>
+class DijkstraRouter : public RouteEngine<Weight> {
+private:
+    using Graph = CsrGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouteEngine<Weight>::RouteInfo;
+
+    static constexpr size_t DEFAULT_MAX_CACHED_TREES = 256;
+
+    // max_cached_trees == 0 - размер кеша не ограничен
+    explicit DijkstraRouter(const Graph& graph, size_t max_cached_trees = DEFAULT_MAX_CACHED_TREES);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const override;
+    std::optional<Weight> BuildRouteEdges(VertexId from, VertexId to, std::vector<EdgeId>& edges) const override;
+    bool UpdateGraph(const GraphDiff<Weight>& diff) override;
+
+private:
+    struct TreeCell {
+        Weight weight;       // INFINITE_WEIGHT - вершина недостижима
+        uint32_t prev_edge;  // NO_EDGE - начальная вершина
+    };
+    using ShortestPathTree = std::vector<TreeCell>;
+
+    std::shared_ptr<const ShortestPathTree> GetShortestPathTree(VertexId from) const;
+    std::optional<RouteInfo> BuildRouteByTree(const ShortestPathTree& tree, VertexId to) const;
+    std::optional<Weight> BuildRouteEdgesByTree(const ShortestPathTree& tree, VertexId to, std::vector<EdgeId>& edges) const;
+    ShortestPathTree ComputeShortestPathTree(VertexId from) const;
+    void ChooseRouterEdges(VertexId from, ShortestPathTree& tree) const;
+    bool IsRouterPathBetter(const ShortestPathTree& tree, uint32_t edge_id, uint32_t other_edge_id,
+                            std::vector<EdgeId>& path, std::vector<EdgeId>& other_path) const;
+    Weight SumAsRouter(const std::vector<EdgeId>& edges, size_t begin, size_t end) const;
+    size_t FindTopVertexEdge(const std::vector<EdgeId>& edges, size_t begin, size_t end) const;
+    static bool IsSameWeight(Weight lhs, Weight rhs);
+    int CompareRouterPaths(const std::vector<EdgeId>& lhs, size_t lhs_begin, size_t lhs_end,
+                           const std::vector<EdgeId>& rhs, size_t rhs_begin, size_t rhs_end) const;
+    bool IsTreeAffected(const ShortestPathTree& tree, const GraphDiff<Weight>& diff) const;
+
+    static constexpr Weight ZERO_WEIGHT = WeightTraits<Weight>::ZERO;
+    static constexpr Weight INFINITE_WEIGHT = WeightTraits<Weight>::INFINITE;
+    static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+    const Graph& graph_;
+    const size_t max_cached_trees_;
+
+    mutable std::mutex trees_mutex_;
+    mutable std::vector<std::shared_ptr<const ShortestPathTree>> trees_;
+    mutable std::deque<VertexId> trees_order_;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph, size_t max_cached_trees)
+    : graph_(graph)
+    , max_cached_trees_(max_cached_trees)
+    , trees_(graph.GetVertexCount())
+{
+    if (graph.GetEdgeCount() >= NO_EDGE) {
+        throw std::length_error("Too many edges for 32-bit edge ids");
+    }
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from,
+                                                                                             VertexId to) const {
+    return BuildRouteByTree(*GetShortestPathTree(from), to);
+}
+
+// Дерево берется из кеша один раз, поэтому не вытесняется другими запросами, пока строятся маршруты
+template <typename Weight>
+std::vector<std::optional<typename DijkstraRouter<Weight>::RouteInfo>> DijkstraRouter<Weight>::BuildRoutes(
+    VertexId from, const std::vector<VertexId>& targets) const {
+    const auto tree = GetShortestPathTree(from);
+    std::vector<std::optional<RouteInfo>> routes;
+    routes.reserve(targets.size());
+    for (const VertexId to : targets) {
+        routes.push_back(BuildRouteByTree(*tree, to));
+    }
+    return routes;
+}
+
+template <typename Weight>
+std::optional<Weight> DijkstraRouter<Weight>::BuildRouteEdges(VertexId from, VertexId to, std::vector<EdgeId>& edges) const {
+    return BuildRouteEdgesByTree(*GetShortestPathTree(from), to, edges);
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRouteByTree(const ShortestPathTree& tree,
+                                                                                                   VertexId to) const {
+    std::vector<EdgeId> edges;
+    const auto weight = BuildRouteEdgesByTree(tree, to, edges);
+    if (!weight) {
+        return std::nullopt;
+    }
+    return RouteInfo{*weight, std::move(edges)};
+}
+
+template <typename Weight>
+std::optional<Weight> DijkstraRouter<Weight>::BuildRouteEdgesByTree(const ShortestPathTree& tree, VertexId to,
+                                                                     std::vector<EdgeId>& edges) const {
+    const TreeCell& cell = tree.at(to);
+    if (cell.weight == INFINITE_WEIGHT) {
+        return std::nullopt;
+    }
+    edges.clear();
+    for (uint32_t edge_id = cell.prev_edge; edge_id != NO_EDGE; edge_id = tree[graph_.GetEdge(edge_id).from].prev_edge) {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    return cell.weight;
+}
+
+template <typename Weight>
+std::shared_ptr<const typename DijkstraRouter<Weight>::ShortestPathTree>
+DijkstraRouter<Weight>::GetShortestPathTree(VertexId from) const {
+    {
+        std::lock_guard guard(trees_mutex_);
+        if (const auto& tree = trees_.at(from)) {
+            return tree;
+        }
+    }
+
+    // Дерево строится без блокировки, чтобы не задерживать запросы из других вершин
+    auto tree = std::make_shared<const ShortestPathTree>(ComputeShortestPathTree(from));
+
+    std::lock_guard guard(trees_mutex_);
+    if (trees_[from]) {
+        return trees_[from];
+    }
+    if (max_cached_trees_ != 0 && trees_order_.size() >= max_cached_trees_) {
+        trees_[trees_order_.front()].reset();
+        trees_order_.pop_front();
+    }
+    trees_[from] = tree;
+    trees_order_.push_back(from);
+    return tree;
+}
+
+// Закешированные деревья, которых изменения не касаются, остаются (с новыми номерами ребер),
+// остальные удаляются и строятся заново при следующем запросе
+template <typename Weight>
+bool DijkstraRouter<Weight>::UpdateGraph(const GraphDiff<Weight>& diff) {
+    if (trees_.size() != graph_.GetVertexCount() || graph_.GetEdgeCount() >= NO_EDGE) {
+        return false;
+    }
+    std::lock_guard guard(trees_mutex_);
+    std::deque<VertexId> trees_order;
+    for (const VertexId from : trees_order_) {
+        auto& tree = trees_[from];
+        if (IsTreeAffected(*tree, diff)) {
+            tree.reset();
+            continue;
+        }
+        auto updated_tree = std::make_shared<ShortestPathTree>(*tree);
+        for (TreeCell& cell : *updated_tree) {
+            if (cell.prev_edge != NO_EDGE) {
+                cell.prev_edge = static_cast<uint32_t>(diff.new_edge_ids[cell.prev_edge]);
+            }
+        }
+        tree = std::move(updated_tree);
+        trees_order.push_back(from);
+    }
+    trees_order_ = std::move(trees_order);
+    return true;
+}
+
+// Поиск с нуля построит то же дерево, если ни одно удаленное ребро в него не входит,
+// а ни одно новое ребро не улучшает и не повторяет вес найденного пути до своего конца
+template <typename Weight>
+bool DijkstraRouter<Weight>::IsTreeAffected(const ShortestPathTree& tree, const GraphDiff<Weight>& diff) const {
+    for (const auto& [edge_id, to] : diff.removed_edges) {
+        if (tree[to].prev_edge == edge_id) {
+            return true;
+        }
+    }
+    for (const EdgeId edge_id : diff.added_edges) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        if (tree[edge.from].weight == INFINITE_WEIGHT) {
+            continue;
+        }
+        const TreeCell& cell_to = tree[edge.to];
+        if (cell_to.weight == INFINITE_WEIGHT || !(cell_to.weight < tree[edge.from].weight + edge.weight)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Weight>
+typename DijkstraRouter<Weight>::ShortestPathTree DijkstraRouter<Weight>::ComputeShortestPathTree(VertexId from) const {
+    using QueueItem = std::pair<Weight, VertexId>;
+
+    ShortestPathTree tree(graph_.GetVertexCount(), TreeCell{INFINITE_WEIGHT, NO_EDGE});
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+    tree[from].weight = ZERO_WEIGHT;
+    queue.push({ZERO_WEIGHT, from});
+    bool has_ties = false; // есть вершина с несколькими путями одного веса
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (tree[vertex].weight < weight) {
+            continue;
+        }
+        for (const auto& edge : graph_.GetOutgoingEdges(vertex)) {
+            const Weight candidate_weight = WeightTraits<Weight>::Add(weight, edge.weight);
+            TreeCell& cell = tree[edge.vertex];
+            if (!has_ties && edge.vertex != from && edge.vertex != vertex && cell.weight != INFINITE_WEIGHT
+                && IsSameWeight(candidate_weight, cell.weight)) {
+                has_ties = true;
+            }
+            if (candidate_weight < cell.weight) {
+                cell = TreeCell{candidate_weight, static_cast<uint32_t>(edge.id)};
+                queue.push({candidate_weight, edge.vertex});
+            }
+        }
+    }
+    if (has_ties) {
+        ChooseRouterEdges(from, tree);
+    }
+    return tree;
+}
+
+// Router обновляет путь только при строгом улучшении, поэтому из равных по весу путей остается путь
+// с меньшей наибольшей промежуточной вершиной (CompareRouterPaths). Такой путь до вершины продолжает
+// такой же путь до начала своего последнего ребра, поэтому последние ребра выбираются среди ребер
+// кратчайших путей в топологическом порядке. Вершины на цикле нулевого веса сохраняют ребро из поиска
+template <typename Weight>
+void DijkstraRouter<Weight>::ChooseRouterEdges(VertexId from, ShortestPathTree& tree) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    const auto is_shortest_edge = [&](VertexId vertex, const auto& edge) {
+        return edge.vertex != from && edge.vertex != vertex
+            && IsSameWeight(WeightTraits<Weight>::Add(tree[vertex].weight, edge.weight), tree[edge.vertex].weight);
+    };
+
+    std::vector<uint32_t> shortest_in_count(vertex_count, 0);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        if (tree[vertex].weight == INFINITE_WEIGHT) {
+            continue;
+        }
+        for (const auto& edge : graph_.GetOutgoingEdges(vertex)) {
+            if (is_shortest_edge(vertex, edge)) {
+                ++shortest_in_count[edge.vertex];
+            }
+        }
+    }
+
+    std::vector<uint32_t> best_edges(vertex_count, NO_EDGE);
+    std::vector<EdgeId> path;
+    std::vector<EdgeId> other_path;
+    std::vector<VertexId> ready{from};
+    while (!ready.empty()) {
+        const VertexId vertex = ready.back();
+        ready.pop_back();
+        if (vertex != from) {
+            tree[vertex].prev_edge = best_edges[vertex];
+        }
+        for (const auto& edge : graph_.GetOutgoingEdges(vertex)) {
+            if (!is_shortest_edge(vertex, edge)) {
+                continue;
+            }
+            uint32_t& best_edge = best_edges[edge.vertex];
+            const auto edge_id = static_cast<uint32_t>(edge.id);
+            if (best_edge == NO_EDGE || IsRouterPathBetter(tree, edge_id, best_edge, path, other_path)) {
+                best_edge = edge_id;
+            }
+            if (--shortest_in_count[edge.vertex] == 0) {
+                ready.push_back(edge.vertex);
+            }
+        }
+    }
+}
+
+// Пути до концов ребер продолжают выбранные пути до их начал
+template <typename Weight>
+bool DijkstraRouter<Weight>::IsRouterPathBetter(const ShortestPathTree& tree, uint32_t edge_id, uint32_t other_edge_id,
+                                                std::vector<EdgeId>& path, std::vector<EdgeId>& other_path) const {
+    const auto build_path = [&](uint32_t last_edge_id, std::vector<EdgeId>& edges) {
+        edges.clear();
+        for (uint32_t id = last_edge_id; id != NO_EDGE; id = tree[graph_.GetEdge(id).from].prev_edge) {
+            edges.push_back(id);
+        }
+        std::reverse(edges.begin(), edges.end());
+    };
+    build_path(edge_id, path);
+    build_path(other_edge_id, other_path);
+    return CompareRouterPaths(path, 0, path.size(), other_path, 0, other_path.size()) < 0;
+}
+
+// Вещественные суммы равных путей зависят от порядка сложения, поэтому равными считаются веса, отличные
+// на погрешность округления, а выбирает между ними CompareRouterPaths по суммам в порядке Router
+template <typename Weight>
+bool DijkstraRouter<Weight>::IsSameWeight(Weight lhs, Weight rhs) {
+    if constexpr (std::is_floating_point_v<Weight>) {
+        constexpr Weight RELATIVE_ERROR = static_cast<Weight>(1e-12);
+        return std::abs(lhs - rhs) <= RELATIVE_ERROR * std::max(lhs, rhs);
+    }
+    else {
+        return lhs == rhs;
+    }
+}
+
+// Позиция ребра, ведущего в наибольшую промежуточную вершину пути; end - промежуточных вершин нет
+template <typename Weight>
+size_t DijkstraRouter<Weight>::FindTopVertexEdge(const std::vector<EdgeId>& edges, size_t begin, size_t end) const {
+    size_t top = end;
+    for (size_t index = begin; index + 1 < end; ++index) {
+        if (top == end || graph_.GetEdge(edges[index]).to > graph_.GetEdge(edges[top]).to) {
+            top = index;
+        }
+    }
+    return top;
+}
+
+// Вес пути, сложенный как в Router: сумма частей до наибольшей промежуточной вершины и после нее
+template <typename Weight>
+Weight DijkstraRouter<Weight>::SumAsRouter(const std::vector<EdgeId>& edges, size_t begin, size_t end) const {
+    const size_t top = FindTopVertexEdge(edges, begin, end);
+    if (top == end) {
+        return graph_.GetEdge(edges[begin]).weight;
+    }
+    return SumAsRouter(edges, begin, top + 1) + SumAsRouter(edges, top + 1, end);
+}
+
+// Порядок Router среди кратчайших путей с общими началом и концом: < 0 - выбран lhs, > 0 - rhs.
+// Путь из одного ребра задан сразу и не заменяется, из параллельных ребер - первое. Иначе путь появляется
+// на шаге его наибольшей промежуточной вершины, и раньше остается навсегда; при общей такой вершине
+// части до нее и после нее - пути, выбранные к этому шагу, и сравниваются так же. Вещественные веса
+// сначала сравниваются суммами в порядке Router: меньшая сумма заменяет путь на любом шаге. Сравниваются
+// только продолжения выбранных путей, а Router после округления может продолжить и другой путь
+template <typename Weight>
+int DijkstraRouter<Weight>::CompareRouterPaths(const std::vector<EdgeId>& lhs, size_t lhs_begin, size_t lhs_end,
+                                               const std::vector<EdgeId>& rhs, size_t rhs_begin, size_t rhs_end) const {
+    if constexpr (std::is_floating_point_v<Weight>) {
+        const Weight lhs_weight = SumAsRouter(lhs, lhs_begin, lhs_end);
+        const Weight rhs_weight = SumAsRouter(rhs, rhs_begin, rhs_end);
+        if (lhs_weight != rhs_weight) {
+            return lhs_weight < rhs_weight ? -1 : 1;
+        }
+    }
+    const size_t lhs_top = FindTopVertexEdge(lhs, lhs_begin, lhs_end);
+    const size_t rhs_top = FindTopVertexEdge(rhs, rhs_begin, rhs_end);
+    if (lhs_top == lhs_end || rhs_top == rhs_end) {
+        if (lhs_top != lhs_end) {
+            return 1;
+        }
+        if (rhs_top != rhs_end) {
+            return -1;
+        }
+        return lhs[lhs_begin] < rhs[rhs_begin] ? -1 : (rhs[rhs_begin] < lhs[lhs_begin] ? 1 : 0);
+    }
+    const VertexId lhs_vertex = graph_.GetEdge(lhs[lhs_top]).to;
+    const VertexId rhs_vertex = graph_.GetEdge(rhs[rhs_top]).to;
+    if (lhs_vertex != rhs_vertex) {
+        return lhs_vertex < rhs_vertex ? -1 : 1;
+    }
+    if (const int result = CompareRouterPaths(lhs, lhs_begin, lhs_top + 1, rhs, rhs_begin, rhs_top + 1); result != 0) {
+        return result;
+    }
+    return CompareRouterPaths(lhs, lhs_top + 1, lhs_end, rhs, rhs_top + 1, rhs_end);
+}
+
+}  // namespace graph
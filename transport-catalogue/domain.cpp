@@ -9,4 +9,8 @@ namespace transportcatalogue {
 		, route_length_in_meters(route_length_in_meters) {
 	}
 
+	int RouteDistances::GetDistance(size_t from, size_t to) const {
+		return from <= to ? forward[to] - forward[from] : backward[from] - backward[to];
+	}
+
 } // transportcatalogue::
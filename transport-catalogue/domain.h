@@ -18,6 +18,16 @@ namespace transportcatalogue {
 		bool is_roundtrip = true;
 	};
 
+	// Расстояния по дорогам от первой остановки маршрута до каждой остановки bus_stops:
+	// forward - по ходу маршрута, backward - в обратную сторону (пролет от i + 1 до i)
+	struct RouteDistances {
+		std::vector<int> forward;
+		std::vector<int> backward;
+
+		// расстояние поездки от остановки from до остановки to (индексы в bus_stops)
+		int GetDistance(size_t from, size_t to) const;
+	};
+
 	struct BusInfo {
 		BusInfo() = default;
 		BusInfo(size_t stops_on_route, size_t unique_stops, double route_length, int route_length_in_meters);
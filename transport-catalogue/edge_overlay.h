@@ -0,0 +1,286 @@
+#pragma once
+
+#include "csr_graph.h"
+#include "graph.h"
+#include "route_engine.h"
+#include "weight_traits.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Изменения графа на время одного запроса: закрытые ребра (битовая маска по номерам ребер)
+// и ребра с другим весом. Сам граф и построенные по нему маршрутизаторы не меняются
+template <typename Weight>
+class EdgeOverlay {
+public:
+    explicit EdgeOverlay(size_t edge_count)
+        : blocked_(edge_count, false)
+        , reweighted_(edge_count, false) {
+    }
+
+    void Block(EdgeId edge_id) {
+        blocked_[edge_id] = true;
+    }
+
+    void SetWeight(EdgeId edge_id, Weight weight) {
+        reweighted_[edge_id] = true;
+        weights_[edge_id] = weight;
+    }
+
+    bool IsBlocked(EdgeId edge_id) const {
+        return blocked_[edge_id];
+    }
+
+    Weight GetWeight(EdgeId edge_id, Weight weight) const {
+        return reweighted_[edge_id] ? weights_.at(edge_id) : weight;
+    }
+
+private:
+    std::vector<bool> blocked_;
+    std::vector<bool> reweighted_;  // чтобы не обращаться к хеш-таблице для остальных ребер
+    std::unordered_map<EdgeId, Weight> weights_;
+};
+
+// Пути алгоритмом Дейкстры из вершины from во все вершины targets (в том же порядке) по графу
+// с наложенными изменениями; поиск останавливается, как только найдены пути до всех targets.
+// Пути те же, что построил бы DijkstraRouter по графу, в котором изменения сделаны на самом деле.
+// get_weight(edge) - вес ребра без изменений, например пересчитанный по другим настройкам
+template <typename Weight, typename GetWeight>
+std::vector<std::optional<typename RouteEngine<Weight>::RouteInfo>> BuildRoutesWithOverlay(const CsrGraph<Weight>& graph,
+                                                                                           const EdgeOverlay<Weight>& overlay,
+                                                                                           VertexId from,
+                                                                                           const std::vector<VertexId>& targets,
+                                                                                           GetWeight get_weight) {
+    using QueueItem = std::pair<Weight, VertexId>;
+    using RouteInfo = typename RouteEngine<Weight>::RouteInfo;
+    constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    constexpr Weight ZERO_WEIGHT = WeightTraits<Weight>::ZERO;
+
+    const size_t vertex_count = graph.GetVertexCount();
+    std::vector<Weight> weights(vertex_count, ZERO_WEIGHT);
+    std::vector<bool> reached(vertex_count, false);
+    std::vector<EdgeId> prev_edges(vertex_count, NO_EDGE);
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+    std::vector<bool> is_target(vertex_count, false);
+    size_t remaining_targets = 0;
+    for (const VertexId to : targets) {
+        if (!is_target[to]) {
+            is_target[to] = true;
+            ++remaining_targets;
+        }
+    }
+
+    reached[from] = true;
+    queue.push({ZERO_WEIGHT, from});
+    while (!queue.empty() && remaining_targets > 0) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (weights[vertex] < weight) {
+            continue;
+        }
+        if (is_target[vertex]) {
+            is_target[vertex] = false;
+            if (--remaining_targets == 0) {
+                break;
+            }
+        }
+        for (const auto& edge : graph.GetOutgoingEdges(vertex)) {
+            if (overlay.IsBlocked(edge.id)) {
+                continue;
+            }
+            const Weight candidate_weight = weight + overlay.GetWeight(edge.id, get_weight(edge));
+            if (!reached[edge.vertex] || candidate_weight < weights[edge.vertex]) {
+                reached[edge.vertex] = true;
+                weights[edge.vertex] = candidate_weight;
+                prev_edges[edge.vertex] = edge.id;
+                queue.push({candidate_weight, edge.vertex});
+            }
+        }
+    }
+
+    std::vector<std::optional<RouteInfo>> routes;
+    routes.reserve(targets.size());
+    for (const VertexId to : targets) {
+        if (!reached[to]) {
+            routes.push_back(std::nullopt);
+            continue;
+        }
+        std::vector<EdgeId> edges;
+        for (EdgeId edge_id = prev_edges[to]; edge_id != NO_EDGE; edge_id = prev_edges[graph.GetEdge(edge_id).from]) {
+            edges.push_back(edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+        routes.push_back(RouteInfo{weights[to], std::move(edges)});
+    }
+    return routes;
+}
+
+// Лучший путь между множествами вершин: номер начальной и конечной вершины в списках и сам путь
+template <typename Weight>
+struct SetRouteInfo {
+    size_t source_index;
+    size_t target_index;
+    typename RouteEngine<Weight>::RouteInfo route;  // вес - без начального и конечного веса
+};
+
+// Один поиск Дейкстры из всех sources сразу: вершина source и вес, с которым путь из нее начинается.
+// Путь заканчивается в одной из targets, к его весу добавляется вес цели; находится путь с наименьшей суммой.
+// Поиск останавливается, как только вес очередной вершины не меньше лучшей найденной суммы
+template <typename Weight, typename GetWeight>
+std::optional<SetRouteInfo<Weight>> BuildRouteBetweenSetsWithOverlay(const CsrGraph<Weight>& graph,
+                                                                     const EdgeOverlay<Weight>& overlay,
+                                                                     const std::vector<std::pair<VertexId, Weight>>& sources,
+                                                                     const std::vector<std::pair<VertexId, Weight>>& targets,
+                                                                     GetWeight get_weight) {
+    using QueueItem = std::pair<Weight, VertexId>;
+    constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    constexpr size_t NO_INDEX = std::numeric_limits<size_t>::max();
+    constexpr Weight ZERO_WEIGHT = WeightTraits<Weight>::ZERO;
+
+    const size_t vertex_count = graph.GetVertexCount();
+    std::vector<Weight> weights(vertex_count, ZERO_WEIGHT);       // с весом начала, порядок поиска
+    std::vector<Weight> path_weights(vertex_count, ZERO_WEIGHT);  // без веса начала
+    std::vector<bool> reached(vertex_count, false);
+    std::vector<EdgeId> prev_edges(vertex_count, NO_EDGE);
+    std::vector<size_t> source_indexes(vertex_count, NO_INDEX);
+    std::vector<size_t> target_indexes(vertex_count, NO_INDEX);
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+    for (size_t index = 0; index < targets.size(); ++index) {
+        size_t& target_index = target_indexes[targets[index].first];
+        if (target_index == NO_INDEX || targets[index].second < targets[target_index].second) {
+            target_index = index;
+        }
+    }
+    for (size_t index = 0; index < sources.size(); ++index) {
+        const auto& [vertex, weight] = sources[index];
+        if (!reached[vertex] || weight < weights[vertex]) {
+            reached[vertex] = true;
+            weights[vertex] = weight;
+            source_indexes[vertex] = index;
+            queue.push({weight, vertex});
+        }
+    }
+
+    std::optional<VertexId> best_target;
+    Weight best_weight = ZERO_WEIGHT;
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (weights[vertex] < weight) {
+            continue;
+        }
+        if (best_target && !(weight < best_weight)) {
+            break;
+        }
+        if (target_indexes[vertex] != NO_INDEX) {
+            const Weight total_weight = weight + targets[target_indexes[vertex]].second;
+            if (!best_target || total_weight < best_weight) {
+                best_target = vertex;
+                best_weight = total_weight;
+            }
+        }
+        for (const auto& edge : graph.GetOutgoingEdges(vertex)) {
+            if (overlay.IsBlocked(edge.id)) {
+                continue;
+            }
+            const Weight edge_weight = overlay.GetWeight(edge.id, get_weight(edge));
+            const Weight candidate_weight = weight + edge_weight;
+            if (!reached[edge.vertex] || candidate_weight < weights[edge.vertex]) {
+                reached[edge.vertex] = true;
+                weights[edge.vertex] = candidate_weight;
+                path_weights[edge.vertex] = path_weights[vertex] + edge_weight;
+                prev_edges[edge.vertex] = edge.id;
+                source_indexes[edge.vertex] = source_indexes[vertex];
+                queue.push({candidate_weight, edge.vertex});
+            }
+        }
+    }
+    if (!best_target) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = prev_edges[*best_target]; edge_id != NO_EDGE; edge_id = prev_edges[graph.GetEdge(edge_id).from]) {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    return SetRouteInfo<Weight>{source_indexes[*best_target], target_indexes[*best_target],
+                                {path_weights[*best_target], std::move(edges)}};
+}
+
+template <typename Weight>
+struct ReachableVertex {
+    VertexId vertex;
+    Weight weight;
+    EdgeId prev_edge;  // последнее ребро пути, у from - NO_EDGE
+
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+};
+
+// Вершины, до которых от from можно дойти с весом не больше max_weight, в порядке веса пути:
+// вершина начала последнего ребра пути всегда стоит раньше. Поиск не выходит за max_weight,
+// поэтому обходит только достижимую часть графа
+template <typename Weight, typename GetWeight>
+std::vector<ReachableVertex<Weight>> FindReachableWithOverlay(const CsrGraph<Weight>& graph,
+                                                                  const EdgeOverlay<Weight>& overlay,
+                                                                  VertexId from, Weight max_weight,
+                                                                  GetWeight get_weight) {
+    using QueueItem = std::pair<Weight, VertexId>;
+    constexpr Weight ZERO_WEIGHT = WeightTraits<Weight>::ZERO;
+
+    const size_t vertex_count = graph.GetVertexCount();
+    std::vector<Weight> weights(vertex_count, ZERO_WEIGHT);
+    std::vector<bool> reached(vertex_count, false);
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    std::vector<EdgeId> prev_edges(vertex_count, ReachableVertex<Weight>::NO_EDGE);
+    std::vector<ReachableVertex<Weight>> reachable;
+
+    reached[from] = true;
+    queue.push({ZERO_WEIGHT, from});
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (weights[vertex] < weight) {
+            continue;
+        }
+        reachable.push_back({vertex, weight, prev_edges[vertex]});
+        for (const auto& edge : graph.GetOutgoingEdges(vertex)) {
+            if (overlay.IsBlocked(edge.id)) {
+                continue;
+            }
+            const Weight candidate_weight = weight + overlay.GetWeight(edge.id, get_weight(edge));
+            if (max_weight < candidate_weight) {
+                continue;
+            }
+            if (!reached[edge.vertex] || candidate_weight < weights[edge.vertex]) {
+                reached[edge.vertex] = true;
+                weights[edge.vertex] = candidate_weight;
+                prev_edges[edge.vertex] = edge.id;
+                queue.push({candidate_weight, edge.vertex});
+            }
+        }
+    }
+    return reachable;
+}
+
+template <typename Weight>
+std::vector<std::optional<typename RouteEngine<Weight>::RouteInfo>> BuildRoutesWithOverlay(const CsrGraph<Weight>& graph,
+                                                                                           const EdgeOverlay<Weight>& overlay,
+                                                                                           VertexId from,
+                                                                                           const std::vector<VertexId>& targets) {
+    return BuildRoutesWithOverlay(graph, overlay, from, targets, [](const auto& edge) {
+        return edge.weight;
+    });
+}
+
+}  // namespace graph
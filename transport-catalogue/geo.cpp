@@ -1,7 +1,9 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
+#include <utility>
 
 namespace transportcatalogue {
     namespace detail {
@@ -17,5 +19,33 @@ namespace transportcatalogue {
 				* 6371000;
 		}
 
+		uint32_t ComputeHilbertIndex(Coordinates point, Coordinates min, Coordinates max) {
+			constexpr uint32_t SIDE = 1u << 16;
+			const auto to_cell = [SIDE](double value, double min_value, double max_value) {
+				if (max_value <= min_value) {
+					return 0u;
+				}
+				const double cell = (value - min_value) / (max_value - min_value) * (SIDE - 1);
+				return static_cast<uint32_t>(std::clamp(cell, 0.0, SIDE - 1.0));
+			};
+			uint32_t x = to_cell(point.lng, min.lng, max.lng);
+			uint32_t y = to_cell(point.lat, min.lat, max.lat);
+			uint32_t index = 0;
+			for (uint32_t side = SIDE / 2; side > 0; side /= 2) {
+				const uint32_t rx = (x & side) ? 1 : 0;
+				const uint32_t ry = (y & side) ? 1 : 0;
+				index += side * side * ((3 * rx) ^ ry);
+				// поворот квадранта
+				if (ry == 0) {
+					if (rx == 1) {
+						x = SIDE - 1 - x;
+						y = SIDE - 1 - y;
+					}
+					std::swap(x, y);
+				}
+			}
+			return index;
+		}
+
     } // end detail::
 } // end transportcatalogue
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
 
 namespace transportcatalogue {
 	namespace detail {
@@ -18,5 +19,9 @@ namespace transportcatalogue {
 
 		double ComputeDistance(Coordinates from, Coordinates to);
 
+		// Номер точки на кривой Гильберта порядка 16 внутри прямоугольника [min, max]:
+		// близкие по номеру точки близки на местности
+		uint32_t ComputeHilbertIndex(Coordinates point, Coordinates min, Coordinates max);
+
 	} // end detail::
 } // end transportcatalogue
\ No newline at end of file
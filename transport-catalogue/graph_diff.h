@@ -0,0 +1,67 @@
+#pragma once
+
+#include "graph.h"
+
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Отличия нового графа от прежнего с тем же множеством вершин. Ребро считается тем же,
+// если совпадают начало, конец и вес; одинаковые ребра сопоставляются в порядке номеров,
+// поэтому относительный порядок неизменившихся ребер сохраняется
+template <typename Weight>
+struct GraphDiff {
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    std::vector<EdgeId> new_edge_ids;                      // по прежнему номеру - номер в новом графе или NO_EDGE
+    std::vector<std::pair<EdgeId, VertexId>> removed_edges; // прежний номер удаленного ребра и его конец
+    std::vector<EdgeId> added_edges;                       // номера в новом графе ребер, которых не было
+
+    bool IsEmpty() const {
+        return removed_edges.empty() && added_edges.empty();
+    }
+};
+
+template <typename Weight>
+GraphDiff<Weight> MakeGraphDiff(const DirectedWeightedGraph<Weight>& old_graph,
+                                const DirectedWeightedGraph<Weight>& new_graph) {
+    GraphDiff<Weight> diff;
+    diff.new_edge_ids.assign(old_graph.GetEdgeCount(), GraphDiff<Weight>::NO_EDGE);
+
+    // прежние ребра из вершины по концу, в порядке номеров
+    std::unordered_map<VertexId, std::vector<EdgeId>> old_edges_by_target;
+    for (VertexId vertex = 0; vertex < new_graph.GetVertexCount(); ++vertex) {
+        old_edges_by_target.clear();
+        for (const EdgeId edge_id : old_graph.GetIncidentEdges(vertex)) {
+            old_edges_by_target[old_graph.GetEdge(edge_id).to].push_back(edge_id);
+        }
+        for (const EdgeId edge_id : new_graph.GetIncidentEdges(vertex)) {
+            const auto& edge = new_graph.GetEdge(edge_id);
+            bool is_matched = false;
+            if (const auto it = old_edges_by_target.find(edge.to); it != old_edges_by_target.end()) {
+                for (EdgeId& old_edge_id : it->second) {
+                    if (old_edge_id != GraphDiff<Weight>::NO_EDGE && old_graph.GetEdge(old_edge_id).weight == edge.weight) {
+                        diff.new_edge_ids[old_edge_id] = edge_id;
+                        old_edge_id = GraphDiff<Weight>::NO_EDGE;
+                        is_matched = true;
+                        break;
+                    }
+                }
+            }
+            if (!is_matched) {
+                diff.added_edges.push_back(edge_id);
+            }
+        }
+    }
+    for (EdgeId edge_id = 0; edge_id < old_graph.GetEdgeCount(); ++edge_id) {
+        if (diff.new_edge_ids[edge_id] == GraphDiff<Weight>::NO_EDGE) {
+            diff.removed_edges.push_back({edge_id, old_graph.GetEdge(edge_id).to});
+        }
+    }
+    return diff;
+}
+
+}  // namespace graph
@@ -1,6 +1,10 @@
 #include "json_reader.h"
 
+#include <algorithm>
 #include <map>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
 
 using namespace std::literals;
 
@@ -104,6 +108,54 @@ void JSONReader::ReadRequestNode(const json::Node& node) {
 			else if (key == "to"s) {
 				request.to = value.AsString();
 			}
+			else if (key == "distance"s) {
+				request.distance = value.AsInt();
+			}
+			else if (key == "stops"s) {
+				for (const auto& stop_name : value.AsArray()) {
+					request.stops.push_back(stop_name.AsString());
+				}
+			}
+			else if (key == "is_roundtrip"s) {
+				request.is_roundtrip = value.AsBool();
+			}
+			else if (key == "excluded_stops"s) {
+				for (const auto& stop_name : value.AsArray()) {
+					request.excluded_stops.push_back(stop_name.AsString());
+				}
+			}
+			else if (key == "excluded_buses"s) {
+				for (const auto& bus_name : value.AsArray()) {
+					request.excluded_buses.push_back(bus_name.AsString());
+				}
+			}
+			else if (key == "profile"s) {
+				request.profile = value.AsString();
+			}
+			else if (key == "origins"s) {
+				for (const auto& stop_name : value.AsArray()) {
+					request.origins.push_back(stop_name.AsString());
+				}
+			}
+			else if (key == "destinations"s) {
+				for (const auto& stop_name : value.AsArray()) {
+					request.destinations.push_back(stop_name.AsString());
+				}
+			}
+			else if (key == "max_time"s) {
+				request.max_time = value.AsDouble();
+			}
+			else if (key == "from_point"s || key == "to_point"s) {
+				transportcatalogue::detail::Coordinates& point = key == "from_point"s ? request.from_point : request.to_point;
+				point.lat = value.AsMap().at("latitude"s).AsDouble();
+				point.lng = value.AsMap().at("longitude"s).AsDouble();
+			}
+			else if (key == "walking_speed"s) {
+				request.walking_speed = value.AsDouble();
+			}
+			else if (key == "walking_radius"s) {
+				request.walking_radius = value.AsDouble();
+			}
 		}
 		requests_.push_back(request);
 	}
@@ -171,7 +223,15 @@ void JSONReader::ReadRenderNode(const json::Node& node) {
 	}
 }
 
+// Количество из настроек; отрицательное не принимается, и остается значение по умолчанию
+void ReadCount(const json::Node& node, size_t& count) {
+	if (node.AsInt() >= 0) {
+		count = static_cast<size_t>(node.AsInt());
+	}
+}
+
 void JSONReader::ReadRoutingSettingsNode(const json::Node& node) {
+	const json::Node* profiles_node = nullptr;
 	for (const auto& [key, value] : node.AsMap()) {
 		if (key == "bus_wait_time"s) {
 			routing_settings_.bus_wait_time = value.AsInt();
@@ -179,6 +239,84 @@ void JSONReader::ReadRoutingSettingsNode(const json::Node& node) {
 		else if (key == "bus_velocity"s) {
 			routing_settings_.bus_velocity = value.AsInt();
 		}
+		else if (key == "router_mode"s) {
+			if (value.AsString() == "all_pairs"s) {
+				routing_settings_.router_mode = router::RouterMode::ALL_PAIRS;
+			}
+			else if (value.AsString() == "all_pairs_blocked"s) {
+				routing_settings_.router_mode = router::RouterMode::ALL_PAIRS_BLOCKED;
+			}
+			else if (value.AsString() == "all_pairs_compact"s) {
+				routing_settings_.router_mode = router::RouterMode::ALL_PAIRS_COMPACT;
+			}
+			else if (value.AsString() == "dijkstra"s) {
+				routing_settings_.router_mode = router::RouterMode::DIJKSTRA;
+			}
+			else if (value.AsString() == "contraction_hierarchy"s) {
+				routing_settings_.router_mode = router::RouterMode::CONTRACTION_HIERARCHY;
+			}
+			else if (value.AsString() == "alt"s) {
+				routing_settings_.router_mode = router::RouterMode::ALT;
+			}
+			else if (value.AsString() == "raptor"s) {
+				routing_settings_.router_mode = router::RouterMode::RAPTOR;
+			}
+		}
+		else if (key == "max_cached_trees"s) {
+			ReadCount(value, routing_settings_.max_cached_trees);
+		}
+		else if (key == "router_threads"s) {
+			ReadCount(value, routing_settings_.router_threads);
+		}
+		else if (key == "alt_landmarks"s) {
+			ReadCount(value, routing_settings_.alt_landmarks);
+		}
+		else if (key == "fixed_point_weights"s) {
+			routing_settings_.fixed_point_weights = value.AsBool();
+		}
+		else if (key == "vertex_order"s) {
+			if (value.AsString() == "catalogue"s) {
+				routing_settings_.vertex_order = router::VertexOrder::CATALOGUE;
+			}
+			else if (value.AsString() == "hilbert"s) {
+				routing_settings_.vertex_order = router::VertexOrder::HILBERT;
+			}
+		}
+		else if (key == "routing_file"s) {
+			routing_settings_.routing_file = value.AsString();
+		}
+		else if (key == "compact_graph"s) {
+			routing_settings_.compact_graph = value.AsBool();
+		}
+		else if (key == "router_build"s) {
+			if (value.AsString() == "lazy"s) {
+				routing_settings_.router_build = router::RouterBuild::LAZY;
+			}
+			else if (value.AsString() == "eager"s) {
+				routing_settings_.router_build = router::RouterBuild::EAGER;
+			}
+		}
+		else if (key == "route_cache_size"s) {
+			ReadCount(value, routing_settings_.route_cache_size);
+		}
+		else if (key == "routing_profiles"s) {
+			profiles_node = &value;
+		}
+	}
+	// незаданные в профиле параметры берутся из основных настроек
+	if (profiles_node != nullptr) {
+		for (const auto& [profile_name, profile_node] : profiles_node->AsMap()) {
+			router::RoutingProfile profile = routing_settings_.GetDefaultProfile();
+			for (const auto& [key, value] : profile_node.AsMap()) {
+				if (key == "bus_wait_time"s) {
+					profile.bus_wait_time = value.AsInt();
+				}
+				else if (key == "bus_velocity"s) {
+					profile.bus_velocity = value.AsInt();
+				}
+			}
+			routing_settings_.profiles[profile_name] = profile;
+		}
 	}
 }
 
@@ -190,10 +328,121 @@ router::RoutingSettings JSONReader::GetRoutingSettings() {
 	return routing_settings_;
 }
 
+RouteAnswerCache::Stats JSONReader::GetRouteCacheStats() const {
+	return route_cache_ ? route_cache_->GetStats() : RouteAnswerCache::Stats{};
+}
+
+json::Node MakeRouteItem(const router::IdEgeInfoForPrint& edges_info) {
+	if (edges_info.IsBus()) {
+		return json::Dict{
+			{"type", json::Node("Bus")},
+			{"bus",  json::Node(edges_info.ptr_bus_route->bus_name)},
+			{"span_count", json::Node(edges_info.span)},
+			{"time", json::Node(edges_info.weight)}
+			};
+	}
+	return json::Dict{
+		{"stop_name",  json::Node(edges_info.ptr_stop->stop_name)},
+		{"time", json::Node(edges_info.weight)},
+		{"type", json::Node("Wait")}
+		};
+}
+
+json::Array MakeRouteItems(const std::vector<router::IdEgeInfoForPrint>& route_items) {
+	json::Array items_route;
+	for (const router::IdEgeInfoForPrint& edges_info : route_items) {
+		items_route.push_back(MakeRouteItem(edges_info));
+	}
+	return items_route;
+}
+
+// Элементы маршрута пишутся в ответ по мере обхода маршрута, без промежуточного вектора
+class RouteItemsWriter : public router::RouteItemVisitor {
+public:
+	explicit RouteItemsWriter(json::Array& items)
+		: items_(items) {
+	}
+
+	void VisitItem(const router::IdEgeInfoForPrint& item) override {
+		items_.push_back(MakeRouteItem(item));
+	}
+
+private:
+	json::Array& items_;
+};
+
+// Ответ Route без request_id: в таком виде он хранится в кеше ответов
+json::Dict MakeRouteAnswerBody(const std::optional<std::pair<std::vector<router::IdEgeInfoForPrint>, double>>& route_info) {
+	if (!route_info.has_value()) {
+		return json::Dict({
+			{"error_message", json::Node("not found")}
+			});
+	}
+	return json::Dict({
+			{"total_time" , json::Node(route_info.value().second)},
+			{"items" , MakeRouteItems(route_info.value().first)}
+		});
+}
+
+json::Node AddRequestId(json::Dict answer, int id) {
+	answer["request_id"s] = json::Node(id);
+	return answer;
+}
+
+// Запросы Route без закрытий с одной начальной остановкой и профилем, между которыми каталог не меняется:
+// номер первого из них -> номера всех. Такие запросы отвечаются одним поиском из начальной остановки
+std::unordered_map<size_t, std::vector<size_t>> GroupRouteRequests(const std::deque<Request>& requests) {
+	std::unordered_map<size_t, std::vector<size_t>> groups;
+	std::map<std::pair<std::string_view, std::string_view>, size_t> first_requests;
+	for (size_t index = 0; index < requests.size(); ++index) {
+		const Request& request = requests[index];
+		if (request.type == "SetDistance"s || request.type == "SetBus"s) {
+			first_requests.clear();
+			continue;
+		}
+		if (request.type != "Route"s || !request.excluded_stops.empty() || !request.excluded_buses.empty()) {
+			continue;
+		}
+		const auto it_first = first_requests.emplace(std::pair{ std::string_view(request.from), std::string_view(request.profile) }, index).first;
+		groups[it_first->second].push_back(index);
+	}
+	return groups;
+}
+
 void JSONReader::GetAnswers(std::ostream& output) {
 	json::Array arr_answers;
 	arr_answers.reserve(requests_.size());
-	for (const auto& [id, type, name, from, to] : requests_) {
+	// маршрутизатор общий для документов с тем же каталогом, после SetDistance и SetBus обновляется при следующем запросе
+	router_service_.SetSettings(routing_settings_);
+	const auto get_router = [this]() -> const router::CreateGraphAndRoute& {
+		return router_service_.GetRouter();
+	};
+	// закрытия из запроса; неизвестные остановки и автобусы пропускаются
+	const auto make_closures = [this](const std::vector<std::string>& excluded_stops, const std::vector<std::string>& excluded_buses) {
+		router::RouteClosures closures;
+		for (const std::string& stop_name : excluded_stops) {
+			if (Stop* ptr_stop = catalogue_.FindStop(stop_name)) {
+				closures.stops.insert(ptr_stop);
+			}
+		}
+		for (const std::string& bus_name : excluded_buses) {
+			if (const Bus* ptr_bus = catalogue_.FindsBus(bus_name)) {
+				closures.buses.insert(ptr_bus);
+			}
+		}
+		return closures;
+	};
+	// версия каталога не отличает ответы по прежним настройкам (ожидание, скорость, профили):
+	// при других настройках, в том числе другом route_cache_size, кеш создается заново
+	if (!route_cache_ || !(route_cache_settings_ == routing_settings_)) {
+		route_cache_ = std::make_unique<RouteAnswerCache>(routing_settings_.route_cache_size);
+		route_cache_settings_ = routing_settings_;
+	}
+	const auto route_groups = GroupRouteRequests(requests_);
+	std::unordered_map<size_t, json::Node> route_answers; // ответы, найденные вместе с первым запросом группы
+	for (size_t index = 0; index < requests_.size(); ++index) {
+		const auto& [id, type, name, from, to, distance, stops, is_roundtrip, excluded_stops, excluded_buses, profile,
+			origins, destinations, max_time, from_point, to_point, walking_speed, walking_radius] = requests_[index];
 		if (type == "Stop"s) {
 			if (!catalogue_.FindStop(name)) {
 				arr_answers.push_back(json::Dict({ 
@@ -222,7 +471,8 @@ void JSONReader::GetAnswers(std::ostream& output) {
 					}));
 			}
 			else {
-				const auto bus_stat = catalogue_.GetBusInfo(name);
+				const std::optional<BusInfo> prepared_stat = startup_tasks_.FindBusInfo(name);
+				const BusInfo bus_stat = prepared_stat ? *prepared_stat : catalogue_.GetBusInfo(name);
 				arr_answers.emplace_back(json::Dict({
 					{"curvature", json::Node(bus_stat.curvature)},
 					{"request_id", json::Node(id)},
@@ -233,48 +483,293 @@ void JSONReader::GetAnswers(std::ostream& output) {
 			}
 		}
 		else if (type == "Route"s) {  
-			static router::CreateGraphAndRoute grapher_route(catalogue_, routing_settings_);
-			std::optional<std::pair<std::vector<router::IdEgeInfoForPrint>, double>> route_info = 
-				grapher_route.BuildRoute(catalogue_.FindStop(from), catalogue_.FindStop(to));
-			
-			if (!route_info.has_value()) {
+			if (const auto it_answer = route_answers.find(index); it_answer != route_answers.end()) {
+				arr_answers.push_back(std::move(it_answer->second));
+				route_answers.erase(it_answer);
+				continue;
+			}
+			const auto it_profile = routing_settings_.profiles.find(profile);
+			if (!profile.empty() && it_profile == routing_settings_.profiles.end()) {
 				arr_answers.emplace_back(json::Dict({
 					{"error_message", json::Node("not found")},
 					{"request_id" , json::Node(id)}
 					}));
+				continue;
 			}
-			else {
-				json::Array items_route;
-				for (const router::IdEgeInfoForPrint edges_info : route_info.value().first) {
-					if (edges_info.IsBus()) {
-						items_route.emplace_back(json::Dict{
-							{"type", json::Node("Bus")},
-							{"bus",  json::Node(edges_info.ptr_bus_route->bus_name)},
-							{"span_count", json::Node(edges_info.span)},
-							{"time", json::Node(edges_info.weight)}
-							});
+			const router::RoutingProfile* ptr_profile = profile.empty() ? nullptr : &it_profile->second;
+			// ответы без закрытий берутся из кеша и кладутся в него; версия каталога отсекает устаревшие
+			const bool is_cacheable = excluded_stops.empty() && excluded_buses.empty();
+			const uint64_t version = catalogue_.GetVersion();
+			const auto make_key = [this](const Request& request) {
+				return RouteAnswerKey{ catalogue_.FindStop(request.from), catalogue_.FindStop(request.to), request.profile };
+			};
+			const auto put_answer = [&](const Request& request, json::Dict answer) {
+				if (is_cacheable) {
+					route_cache_->Put(make_key(request), std::make_shared<const json::Dict>(answer), version);
+				}
+				return AddRequestId(std::move(answer), request.id);
+			};
+			if (is_cacheable) {
+				if (const auto cached_answer = route_cache_->Get(make_key(requests_[index]), version)) {
+					arr_answers.push_back(AddRequestId(**cached_answer, id));
+					continue;
+				}
+			}
+			if (const auto it_group = route_groups.find(index); it_group != route_groups.end() && it_group->second.size() > 1) {
+				// одним поиском ищутся маршруты группы, которых нет в кеше, каждая конечная остановка - один раз
+				std::vector<const Stop*> group_to;
+				std::unordered_map<const Stop*, size_t> searched_to; // конечная остановка -> номер в group_to
+				std::unordered_map<size_t, std::shared_ptr<const json::Dict>> cached_answers;
+				for (const size_t group_index : it_group->second) {
+					const Stop* ptr_stop_to = catalogue_.FindStop(requests_[group_index].to);
+					if (searched_to.count(ptr_stop_to) != 0) {
+						continue;
+					}
+					if (group_index != index) {
+						if (auto cached_answer = route_cache_->Get(make_key(requests_[group_index]), version)) {
+							cached_answers.emplace(group_index, std::move(*cached_answer));
+							continue;
+						}
 					}
-					else {
-						items_route.emplace_back(json::Dict{
-							{"stop_name",  json::Node(edges_info.ptr_stop->stop_name)},
-							{"time", json::Node(edges_info.weight)},
-							{"type", json::Node("Wait")}
-							});
+					searched_to.emplace(ptr_stop_to, group_to.size());
+					group_to.push_back(ptr_stop_to);
+				}
+				if (it_group->second.size() > cached_answers.size() + 1) {
+					const auto routes_info = get_router().BuildRoutes(catalogue_.FindStop(from), group_to, ptr_profile);
+					std::vector<std::shared_ptr<const json::Dict>> searched_answers;
+					searched_answers.reserve(routes_info.size());
+					for (size_t i = 0; i < routes_info.size(); ++i) {
+						searched_answers.push_back(std::make_shared<const json::Dict>(MakeRouteAnswerBody(routes_info[i])));
+						route_cache_->Put({ catalogue_.FindStop(from), group_to[i], profile }, searched_answers.back(), version);
+					}
+					for (const size_t group_index : it_group->second) {
+						const auto it_cached = cached_answers.find(group_index);
+						const json::Dict& answer = it_cached != cached_answers.end() ? *it_cached->second
+							: *searched_answers[searched_to.at(catalogue_.FindStop(requests_[group_index].to))];
+						if (group_index == index) {
+							arr_answers.push_back(AddRequestId(answer, id));
+						}
+						else {
+							route_answers.emplace(group_index, AddRequestId(answer, requests_[group_index].id));
+						}
 					}
+					continue;
+				}
+				for (auto& [group_index, answer] : cached_answers) {
+					route_answers.emplace(group_index, AddRequestId(*answer, requests_[group_index].id));
 				}
+			}
+			json::Array items_route;
+			RouteItemsWriter items_writer(items_route);
+			const std::optional<double> total_time = get_router().VisitRoute(catalogue_.FindStop(from), catalogue_.FindStop(to),
+				make_closures(excluded_stops, excluded_buses), ptr_profile, items_writer);
+			if (!total_time) {
+				arr_answers.push_back(put_answer(requests_[index], MakeRouteAnswerBody(std::nullopt)));
+				continue;
+			}
+			arr_answers.push_back(put_answer(requests_[index], json::Dict({
+				{"total_time" , json::Node(*total_time)},
+				{"items" , std::move(items_route)}
+				})));
+		}
+		else if (type == "RouteCacheStats"s) {
+			const RouteAnswerCache::Stats stats = route_cache_->GetStats();
+			arr_answers.emplace_back(json::Dict({
+				{"request_id" , json::Node(id)},
+				{"capacity" , json::Node(static_cast<int>(route_cache_->GetCapacity()))},
+				{"hits" , json::Node(static_cast<int>(stats.hits))},
+				{"misses" , json::Node(static_cast<int>(stats.misses))},
+				{"evictions" , json::Node(static_cast<int>(stats.evictions))}
+				}));
+		}
+		else if (type == "PointRoute"s) {
+			// маршрут между точками: пешком до одной из остановок в радиусе walking_radius, на автобусах
+			// и пешком от остановки; все остановки у начальной точки - начала одного поиска
+			const auto it_profile = routing_settings_.profiles.find(profile);
+			if (!profile.empty() && it_profile == routing_settings_.profiles.end()) {
 				arr_answers.emplace_back(json::Dict({
-						{"request_id" , json::Node(id)},
-						{"total_time" , json::Node(route_info.value().second)},
-						{"items" , items_route}
+					{"error_message", json::Node("not found")},
+					{"request_id" , json::Node(id)}
 					}));
+				continue;
 			}
+			const router::CreateGraphAndRoute& grapher = get_router();
+			const double walking_meters_per_minute = walking_speed * 1000.0 / 60;
+			const auto make_endpoints = [&grapher, walking_radius, walking_meters_per_minute](transportcatalogue::detail::Coordinates point) {
+				std::vector<router::RouteEndpoint> endpoints;
+				for (const auto& [ptr_stop, walking_distance] : grapher.FindStopsNear(point, walking_radius)) {
+					endpoints.push_back({ ptr_stop, walking_distance / walking_meters_per_minute });
+				}
+				return endpoints;
+			};
+			const std::vector<router::RouteEndpoint> from_stops = make_endpoints(from_point);
+			const std::vector<router::RouteEndpoint> to_stops = make_endpoints(to_point);
+			const std::optional<router::SetRoute> route = grapher.BuildRouteBetweenSets(from_stops, to_stops,
+				make_closures(excluded_stops, excluded_buses), profile.empty() ? nullptr : &it_profile->second);
+			if (!route) {
+				arr_answers.emplace_back(json::Dict({
+					{"error_message", json::Node("not found")},
+					{"request_id" , json::Node(id)}
+					}));
+				continue;
+			}
+			const router::RouteEndpoint& from_stop = from_stops[route->from_index];
+			const router::RouteEndpoint& to_stop = to_stops[route->to_index];
+			json::Array items_route = MakeRouteItems(route->items);
+			items_route.insert(items_route.begin(), json::Dict{
+				{"stop_name", json::Node(from_stop.stop->stop_name)},
+				{"time", json::Node(from_stop.time)},
+				{"type", json::Node("Walk")}
+				});
+			items_route.emplace_back(json::Dict{
+				{"stop_name", json::Node(to_stop.stop->stop_name)},
+				{"time", json::Node(to_stop.time)},
+				{"type", json::Node("Walk")}
+				});
+			arr_answers.emplace_back(json::Dict({
+				{"request_id" , json::Node(id)},
+				{"total_time" , json::Node(route->total_time)},
+				{"items" , json::Node(std::move(items_route))}
+				}));
+		}
+		else if (type == "HubRoute"s) {
+			// лучший маршрут из любой остановки origins в любую destinations (например, платформы двух узлов):
+			// один поиск сразу из всех origins, ответ - маршрут и выбранные остановки
+			const auto it_profile = routing_settings_.profiles.find(profile);
+			std::vector<router::RouteEndpoint> from_stops;
+			std::vector<router::RouteEndpoint> to_stops;
+			for (const std::string& stop_name : origins) {
+				from_stops.push_back({ catalogue_.FindStop(stop_name), 0 });
+			}
+			for (const std::string& stop_name : destinations) {
+				to_stops.push_back({ catalogue_.FindStop(stop_name), 0 });
+			}
+			const auto is_missing = [](const router::RouteEndpoint& endpoint) { return endpoint.stop == nullptr; };
+			if ((!profile.empty() && it_profile == routing_settings_.profiles.end())
+				|| std::any_of(from_stops.begin(), from_stops.end(), is_missing)
+				|| std::any_of(to_stops.begin(), to_stops.end(), is_missing)) {
+				arr_answers.emplace_back(json::Dict({
+					{"error_message", json::Node("not found")},
+					{"request_id" , json::Node(id)}
+					}));
+				continue;
+			}
+			const std::optional<router::SetRoute> route = get_router().BuildRouteBetweenSets(from_stops, to_stops,
+				make_closures(excluded_stops, excluded_buses), profile.empty() ? nullptr : &it_profile->second);
+			if (!route) {
+				arr_answers.emplace_back(json::Dict({
+					{"error_message", json::Node("not found")},
+					{"request_id" , json::Node(id)}
+					}));
+				continue;
+			}
+			arr_answers.emplace_back(json::Dict({
+				{"request_id" , json::Node(id)},
+				{"from" , json::Node(from_stops[route->from_index].stop->stop_name)},
+				{"to" , json::Node(to_stops[route->to_index].stop->stop_name)},
+				{"total_time" , json::Node(route->total_time)},
+				{"items" , json::Node(MakeRouteItems(route->items))}
+				}));
+		}
+		else if (type == "Isochrone"s) {
+			// остановки, до которых можно доехать из from не дольше max_time минут, по возрастанию времени
+			const auto it_profile = routing_settings_.profiles.find(profile);
+			if ((!profile.empty() && it_profile == routing_settings_.profiles.end()) || !catalogue_.FindStop(from)) {
+				arr_answers.emplace_back(json::Dict({
+					{"error_message", json::Node("not found")},
+					{"request_id" , json::Node(id)}
+					}));
+				continue;
+			}
+			const auto reachable_stops = get_router().FindReachableStops(catalogue_.FindStop(from), max_time,
+				make_closures(excluded_stops, excluded_buses), profile.empty() ? nullptr : &it_profile->second);
+			json::Array stops_time;
+			stops_time.reserve(reachable_stops.size());
+			for (const auto& [ptr_stop, time] : reachable_stops) {
+				stops_time.emplace_back(json::Dict{
+					{"stop_name", json::Node(ptr_stop->stop_name)},
+					{"time", json::Node(time)}
+					});
+			}
+			arr_answers.emplace_back(json::Dict({
+				{"request_id" , json::Node(id)},
+				{"stops" , json::Node(std::move(stops_time))}
+				}));
+		}
+		else if (type == "Matrix"s) {
+			// время в пути из каждой остановки origins в каждую destinations, null - маршрута нет
+			const auto it_profile = routing_settings_.profiles.find(profile);
+			std::vector<const Stop*> origin_stops;
+			std::vector<const Stop*> destination_stops;
+			for (const std::string& stop_name : origins) {
+				origin_stops.push_back(catalogue_.FindStop(stop_name));
+			}
+			for (const std::string& stop_name : destinations) {
+				destination_stops.push_back(catalogue_.FindStop(stop_name));
+			}
+			const auto is_missing = [](const Stop* ptr_stop) { return ptr_stop == nullptr; };
+			if ((!profile.empty() && it_profile == routing_settings_.profiles.end())
+				|| std::any_of(origin_stops.begin(), origin_stops.end(), is_missing)
+				|| std::any_of(destination_stops.begin(), destination_stops.end(), is_missing)) {
+				arr_answers.emplace_back(json::Dict({
+					{"error_message", json::Node("not found")},
+					{"request_id" , json::Node(id)}
+					}));
+				continue;
+			}
+			json::Array times;
+			times.reserve(origin_stops.size());
+			for (const Stop* ptr_origin : origin_stops) {
+				const auto routes_info = get_router().BuildRoutes(ptr_origin, destination_stops,
+					profile.empty() ? nullptr : &it_profile->second);
+				json::Array row;
+				row.reserve(routes_info.size());
+				for (const auto& route_info : routes_info) {
+					row.push_back(route_info ? json::Node(route_info->second) : json::Node(nullptr));
+				}
+				times.emplace_back(std::move(row));
+			}
+			arr_answers.emplace_back(json::Dict({
+				{"request_id" , json::Node(id)},
+				{"times" , json::Node(std::move(times))}
+				}));
+		}
+		else if (type == "SetDistance"s || type == "SetBus"s) {
+			// изменение каталога между запросами: построенный маршрутизатор обновляется, а не строится заново.
+			// Автобус без остановок не принимается: для него не считается ни статистика, ни маршрут
+			const bool is_found = type == "SetDistance"s
+				? catalogue_.FindStop(from) && catalogue_.FindStop(to)
+				: catalogue_.FindsBus(name) && !stops.empty() && std::all_of(stops.begin(), stops.end(), [this](const std::string& stop_name) {
+					return catalogue_.FindStop(stop_name) != nullptr;
+				});
+			if (!is_found) {
+				arr_answers.emplace_back(json::Dict({
+					{"error_message", json::Node("not found")},
+					{"request_id" , json::Node(id)}
+					}));
+				continue;
+			}
+			startup_tasks_.WaitAll();
+			if (type == "SetDistance"s) {
+				catalogue_.SetDistanceBetweenStops(from, to, distance);
+			}
+			else {
+				catalogue_.SetBusStops(name, std::vector<std::string_view>(stops.begin(), stops.end()), is_roundtrip);
+			}
+			arr_answers.emplace_back(json::Dict({
+				{"request_id" , json::Node(id)}
+				}));
 		}
 		else if (type == "Map"s) {
-			std::stringstream ss_draw_buses;
-			renderer::MapRenderer map_renderer(settings_);
-			map_renderer.DrawBuses(std::move(catalogue_.GetListAllBuses()), ss_draw_buses);
+			std::optional<std::string> prepared_map = startup_tasks_.GetMap();
+			if (!prepared_map) {
+				std::stringstream ss_draw_buses;
+				renderer::MapRenderer map_renderer(settings_);
+				map_renderer.DrawBuses(std::move(catalogue_.GetListAllBuses()), ss_draw_buses);
+				prepared_map = ss_draw_buses.str();
+			}
 			arr_answers.emplace_back(json::Dict({
-				{"map", json::Node(ss_draw_buses.str())},
+				{"map", json::Node(std::move(*prepared_map))},
 				{"request_id" , json::Node(id)}
 				}));
 		}
@@ -283,6 +778,12 @@ void JSONReader::GetAnswers(std::ostream& output) {
 }
 
 void JSONReader::Load(std::istream& input) {
+	// запросы и настройки прежнего документа не наследуются: незаданные ключи берут значения по умолчанию
+	stops_cache_.clear();
+	bus_cache_.clear();
+	requests_.clear();
+	settings_ = {};
+	routing_settings_ = {};
 
 	json::Document doc = json::Document{ json::Load(input) };
 
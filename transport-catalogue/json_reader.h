@@ -8,6 +8,11 @@
 #include "map_renderer.h"
 #include "json_builder.h"
 #include "transport_router.h"
+#include "router_service.h"
+#include "startup_tasks.h"
+#include "sharded_cache.h"
+
+#include <memory>
 
 struct StopJSON {
 	double latitude = .0;
@@ -28,27 +33,67 @@ struct Request {
 	std::string name;
 	std::string from;
 	std::string to;
+	int distance = 0;                 // SetDistance
+	std::vector<std::string> stops;   // SetBus
+	bool is_roundtrip = false;        // SetBus
+	std::vector<std::string> excluded_stops; // Route: закрытые остановки
+	std::vector<std::string> excluded_buses; // Route: закрытые автобусы
+	std::string profile;                     // Route, Matrix, Isochrone, HubRoute: профиль из routing_profiles, пусто - по умолчанию
+	std::vector<std::string> origins;        // Matrix, HubRoute
+	std::vector<std::string> destinations;   // Matrix, HubRoute
+	double max_time = 0;                     // Isochrone: минуты
+	transportcatalogue::detail::Coordinates from_point{}; // PointRoute
+	transportcatalogue::detail::Coordinates to_point{};   // PointRoute
+	double walking_speed = 5;                // PointRoute: км/час
+	double walking_radius = 1000;            // PointRoute: м, в каком радиусе от точек искать остановки
+};
+
+// Ключ кеша ответов Route: запросы без закрытий с теми же остановками и профилем отвечаются одинаково
+struct RouteAnswerKey {
+	const Stop* from = nullptr;
+	const Stop* to = nullptr;
+	std::string profile;
+
+	bool operator==(const RouteAnswerKey& other) const {
+		return from == other.from && to == other.to && profile == other.profile;
+	}
 };
 
+struct RouteAnswerKeyHasher {
+	size_t operator()(const RouteAnswerKey& key) const {
+		return std::hash<const void*>{}(key.from) + std::hash<const void*>{}(key.to) * 37
+			+ std::hash<std::string>{}(key.profile) * 37 * 37;
+	}
+};
+
+// Готовые ответы Route без request_id, версия - версия каталога
+using RouteAnswerCache = concurrency::ShardedClockCache<RouteAnswerKey, std::shared_ptr<const json::Dict>, RouteAnswerKeyHasher>;
+
 class JSONReader {
 public:
 	JSONReader() = default;
 
-	JSONReader(transportcatalogue::TransportCatalogue& catalogue) : catalogue_(catalogue) {}
+	JSONReader(transportcatalogue::TransportCatalogue& catalogue, router::RouterService& router_service, StartupTasks& startup_tasks)
+		: catalogue_(catalogue), router_service_(router_service), startup_tasks_(startup_tasks) {}
 
 	void Load(std::istream& input);
 	void GetAnswers(std::ostream& output);
 	renderer::Settings GetRenderSettings();
 	router::RoutingSettings GetRoutingSettings();
+	RouteAnswerCache::Stats GetRouteCacheStats() const;
 
 private:
 
 	transportcatalogue::TransportCatalogue& catalogue_;
+	router::RouterService& router_service_;
+	StartupTasks& startup_tasks_;
 	std::deque<StopJSON> stops_cache_;
 	std::deque<BusJSON> bus_cache_;
 	std::deque<Request> requests_;
 	renderer::Settings settings_;
 	router::RoutingSettings routing_settings_;
+	std::unique_ptr<RouteAnswerCache> route_cache_; // создается при первом GetAnswers по route_cache_size
+	router::RoutingSettings route_cache_settings_;   // настройки, по которым найдены ответы в route_cache_
 
 	void AddStopToCash(const json::Node& node);
 	void AddBusToCash(const json::Node& node);
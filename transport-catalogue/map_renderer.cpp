@@ -184,6 +184,10 @@ namespace renderer {
 	}
 
     svg::Color GetColorBus::operator()() {
+        // документ без render_settings: палитра пуста
+        if (color_palette_.empty()) {
+            return svg::NoneColor;
+        }
         auto result = it_;
         ++it_;
         if (it_ == color_palette_.end()) {
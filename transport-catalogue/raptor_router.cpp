@@ -0,0 +1,282 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace router {
+
+	RaptorRouter::RaptorRouter(const transportcatalogue::TransportCatalogue& catalogue, RoutingSettings routing_settings)
+		: routing_settings_(routing_settings),
+		stops_(catalogue.GetListPtrAllStops()) {
+		std::sort(stops_.begin(), stops_.end(), [](const Stop* lhs, const Stop* rhs) { return lhs->stop_name < rhs->stop_name; });
+		for (StopIndex index = 0; index < stops_.size(); ++index) {
+			stop_index_[stops_[index]] = index;
+		}
+		stop_directions_.resize(stops_.size());
+
+		for (const Bus* ptr_bus : catalogue.GetListAllBuses()) {
+			if (ptr_bus->bus_stops.size() < 2) { continue; }
+			const RouteDistances& route_distances = catalogue.GetRouteDistances(ptr_bus);
+			std::vector<StopIndex> stops;
+			for (Stop* ptr_stop : ptr_bus->bus_stops) {
+				stops.push_back(stop_index_.at(ptr_stop));
+			}
+			if (!ptr_bus->is_roundtrip) {
+				// обратное направление: расстояния считаются от конечной остановки
+				const size_t last = stops.size() - 1;
+				std::vector<StopIndex> stops_backward(stops.rbegin(), stops.rend());
+				std::vector<int> distances(stops.size());
+				for (size_t i = 0; i < distances.size(); ++i) {
+					distances[i] = route_distances.GetDistance(last, last - i);
+				}
+				AddDirection(ptr_bus, std::move(stops), route_distances.forward);
+				AddDirection(ptr_bus, std::move(stops_backward), std::move(distances));
+			}
+			else {
+				AddDirection(ptr_bus, std::move(stops), route_distances.forward);
+			}
+		}
+	}
+
+	void RaptorRouter::AddDirection(const Bus* bus, std::vector<StopIndex> stops, std::vector<int> distances) {
+		const auto direction = static_cast<uint32_t>(directions_.size());
+		for (uint32_t position = 0; position < stops.size(); ++position) {
+			stop_directions_[stops[position]].push_back({ direction, position });
+		}
+		directions_.push_back({ bus, std::move(stops), std::move(distances) });
+	}
+
+	std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>> RaptorRouter::BuildRoute(const Stop* from, const Stop* to,
+		const RouteClosures& closures, const RoutingProfile& profile) const {
+		return std::move(BuildRoutes(from, { to }, closures, profile).front());
+	}
+
+	std::vector<std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>>> RaptorRouter::BuildRoutes(const Stop* from,
+		const std::vector<const Stop*>& to, const RouteClosures& closures, const RoutingProfile& profile) const {
+		std::vector<std::pair<StopIndex, double>> targets;
+		for (const Stop* ptr_stop_to : to) {
+			targets.push_back({ stop_index_.at(ptr_stop_to), 0.0 });
+		}
+		const Rounds rounds = RunRounds({ { stop_index_.at(from), 0.0 } }, targets, false, INFINITE_TIME, closures, profile);
+
+		std::vector<std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>>> routes;
+		routes.reserve(targets.size());
+		for (const auto& [target, target_time] : targets) {
+			if (rounds.best_arrivals[target] == INFINITE_TIME) {
+				routes.push_back(std::nullopt);
+				continue;
+			}
+			routes.push_back(std::pair{ ExtractRoute(rounds, target, profile).first, rounds.best_arrivals[target] });
+		}
+		return routes;
+	}
+
+	std::optional<SetRoute> RaptorRouter::BuildRouteBetweenSets(const std::vector<RouteEndpoint>& from, const std::vector<RouteEndpoint>& to,
+		const RouteClosures& closures, const RoutingProfile& profile) const {
+		std::vector<std::pair<StopIndex, double>> sources;
+		for (const RouteEndpoint& endpoint : from) {
+			sources.push_back({ stop_index_.at(endpoint.stop), endpoint.time });
+		}
+		std::vector<std::pair<StopIndex, double>> targets;
+		for (const RouteEndpoint& endpoint : to) {
+			targets.push_back({ stop_index_.at(endpoint.stop), endpoint.time });
+		}
+		const Rounds rounds = RunRounds(sources, targets, true, INFINITE_TIME, closures, profile);
+
+		// при равном времени выбирается первая цель
+		std::optional<size_t> best_target;
+		double best_time = INFINITE_TIME;
+		for (size_t index = 0; index < targets.size(); ++index) {
+			const double time = rounds.best_arrivals[targets[index].first] + targets[index].second;
+			if (time < best_time) {
+				best_target = index;
+				best_time = time;
+			}
+		}
+		if (!best_target) {
+			return std::nullopt;
+		}
+		auto [vector_info_edges, source] = ExtractRoute(rounds, targets[*best_target].first, profile);
+		// начало маршрута - кандидат с наименьшим временем на этой остановке
+		size_t best_source = 0;
+		while (sources[best_source].first != source || sources[best_source].second != rounds.arrivals[0][source]) {
+			++best_source;
+		}
+		return SetRoute{ best_source, *best_target, std::move(vector_info_edges), best_time };
+	}
+
+	std::vector<std::pair<Stop*, double>> RaptorRouter::FindReachableStops(const Stop* from, double max_time,
+		const RouteClosures& closures, const RoutingProfile& profile) const {
+		const Rounds rounds = RunRounds({ { stop_index_.at(from), 0.0 } }, {}, false, max_time, closures, profile);
+		std::vector<std::pair<Stop*, double>> reachable_stops;
+		for (StopIndex stop = 0; stop < stops_.size(); ++stop) {
+			if (rounds.best_arrivals[stop] <= max_time) {
+				reachable_stops.push_back({ stops_[stop], rounds.best_arrivals[stop] });
+			}
+		}
+		return reachable_stops;
+	}
+
+	// Элементы маршрута до target по меткам раундов и остановка, с которой он начинается
+	std::pair<std::vector<IdEgeInfoForPrint>, RaptorRouter::StopIndex> RaptorRouter::ExtractRoute(const Rounds& rounds, StopIndex target,
+		const RoutingProfile& profile) const {
+		const double wait_time = profile.bus_wait_time * 1.0;
+		size_t round = rounds.arrivals.size() - 1;
+		while (rounds.arrivals[round][target] != rounds.best_arrivals[target]) {
+			--round;
+		}
+		std::vector<IdEgeInfoForPrint> vector_info_edges;
+		StopIndex stop = target;
+		for (; round > 0; --round) {
+			const Label& label = rounds.labels[round][stop];
+			const RouteDirection& route = directions_[label.direction];
+			const StopIndex board_stop = route.stops[label.board_position];
+			const double ride_time = profile.GetRideTime(route.distances[label.alight_position] - route.distances[label.board_position]);
+			vector_info_edges.push_back({ route.bus, nullptr, static_cast<int>(label.alight_position - label.board_position), ride_time });
+			vector_info_edges.push_back({ nullptr, stops_[board_stop], 0, wait_time });
+			stop = board_stop;
+		}
+		std::reverse(vector_info_edges.begin(), vector_info_edges.end());
+		return { std::move(vector_info_edges), stop };
+	}
+
+	// Начальные остановки sources - со своим временем отправления. Цели targets: is_any_target - нужен лучший
+	// маршрут до одной из них с учетом добавляемого к ней времени, иначе - маршруты до всех.
+	// Без целей раунды идут до всех остановок, достижимых за time_limit
+	RaptorRouter::Rounds RaptorRouter::RunRounds(const std::vector<std::pair<StopIndex, double>>& sources,
+		const std::vector<std::pair<StopIndex, double>>& targets, bool is_any_target, double time_limit,
+		const RouteClosures& closures, const RoutingProfile& profile) const {
+		constexpr uint32_t NOT_MARKED = std::numeric_limits<uint32_t>::max();
+
+		std::vector<bool> is_target(stops_.size(), false);
+		std::vector<double> target_times(stops_.size(), INFINITE_TIME);
+		for (const auto& [target, time] : targets) {
+			is_target[target] = true;
+			target_times[target] = std::min(target_times[target], time);
+		}
+		const double wait_time = profile.bus_wait_time * 1.0;
+
+		// закрытые автобусы не просматриваются, на закрытых остановках нельзя сесть и выйти
+		std::vector<bool> closed_stops(stops_.size(), false);
+		for (const Stop* ptr_stop : closures.stops) {
+			if (const auto it = stop_index_.find(ptr_stop); it != stop_index_.end()) {
+				closed_stops[it->second] = true;
+			}
+		}
+		std::vector<bool> closed_directions(directions_.size(), false);
+		for (uint32_t direction = 0; direction < directions_.size(); ++direction) {
+			closed_directions[direction] = closures.buses.count(directions_[direction].bus) > 0;
+		}
+
+		Rounds rounds;
+		auto& [arrivals, labels, best_arrivals] = rounds;
+		arrivals.assign(1, std::vector<double>(stops_.size(), INFINITE_TIME));
+		labels.assign(1, std::vector<Label>(stops_.size()));
+		best_arrivals.assign(stops_.size(), INFINITE_TIME);
+		std::vector<StopIndex> marked_stops;
+		for (const auto& [source, time] : sources) {
+			if (time < arrivals[0][source]) {
+				arrivals[0][source] = time;
+				best_arrivals[source] = time;
+				marked_stops.push_back(source);
+			}
+		}
+		std::sort(marked_stops.begin(), marked_stops.end());
+		marked_stops.erase(std::unique(marked_stops.begin(), marked_stops.end()), marked_stops.end());
+
+		// прибытие не позже этого времени не улучшит ни одного маршрута: худшее из лучших времен до целей
+		// или, если нужна одна цель, лучшее время до цели с добавляемым временем
+		size_t unreached_targets = 0;
+		for (StopIndex stop = 0; stop < stops_.size(); ++stop) {
+			if (is_target[stop] && best_arrivals[stop] == INFINITE_TIME) {
+				++unreached_targets;
+			}
+		}
+		const auto compute_target_bound = [&]() {
+			if (is_any_target) {
+				double bound = INFINITE_TIME;
+				for (const auto& [target, time] : targets) {
+					bound = std::min(bound, best_arrivals[target] + time);
+				}
+				return bound;
+			}
+			if (unreached_targets > 0 || targets.empty()) {
+				return INFINITE_TIME;
+			}
+			double bound = 0;
+			for (const auto& [target, time] : targets) {
+				bound = std::max(bound, best_arrivals[target]);
+			}
+			return bound;
+		};
+		double target_bound = compute_target_bound();
+		std::vector<uint32_t> first_marked_position(directions_.size(), NOT_MARKED);
+
+		while (!marked_stops.empty()) {
+			// направления, проходящие через улучшенные остановки, с самой ранней такой позицией
+			std::vector<uint32_t> queued_directions;
+			for (const StopIndex stop : marked_stops) {
+				if (closed_stops[stop]) { continue; }
+				for (const auto& [direction, position] : stop_directions_[stop]) {
+					if (closed_directions[direction]) { continue; }
+					if (first_marked_position[direction] == NOT_MARKED) {
+						queued_directions.push_back(direction);
+					}
+					first_marked_position[direction] = std::min(first_marked_position[direction], position);
+				}
+			}
+			marked_stops.clear();
+			std::sort(queued_directions.begin(), queued_directions.end());
+
+			const std::vector<double>& prev_arrivals = arrivals.back();
+			std::vector<double> round_arrivals(stops_.size(), INFINITE_TIME);
+			std::vector<Label> round_labels(stops_.size());
+
+			for (const uint32_t direction : queued_directions) {
+				const RouteDirection& route = directions_[direction];
+				std::optional<uint32_t> board_position;
+				for (uint32_t position = first_marked_position[direction]; position < route.stops.size(); ++position) {
+					const StopIndex stop = route.stops[position];
+					if (closed_stops[stop]) { continue; }
+					if (board_position) {
+						const double arrival = prev_arrivals[route.stops[*board_position]] + wait_time
+							+ profile.GetRideTime(route.distances[position] - route.distances[*board_position]);
+						if (arrival < best_arrivals[stop] && arrival < target_bound && arrival <= time_limit) {
+							const bool is_first_arrival = best_arrivals[stop] == INFINITE_TIME;
+							best_arrivals[stop] = arrival;
+							round_arrivals[stop] = arrival;
+							round_labels[stop] = { direction, *board_position, position };
+							marked_stops.push_back(stop);
+							if (is_target[stop] && is_any_target) {
+								target_bound = std::min(target_bound, arrival + target_times[stop]);
+							}
+							else if (is_target[stop]) {
+								if (is_first_arrival) {
+									--unreached_targets;
+								}
+								// пока достигнуты не все цели, граница бесконечна
+								if (unreached_targets == 0) {
+									target_bound = compute_target_bound();
+								}
+							}
+						}
+					}
+					// садиться выгоднее там, где меньше время прибытия за вычетом уже проеханного пути
+					if (prev_arrivals[stop] != INFINITE_TIME && (!board_position
+						|| prev_arrivals[stop] - profile.GetRideTime(route.distances[position])
+						< prev_arrivals[route.stops[*board_position]] - profile.GetRideTime(route.distances[*board_position]))) {
+						board_position = position;
+					}
+				}
+				first_marked_position[direction] = NOT_MARKED;
+			}
+
+			std::sort(marked_stops.begin(), marked_stops.end());
+			marked_stops.erase(std::unique(marked_stops.begin(), marked_stops.end()), marked_stops.end());
+			arrivals.push_back(std::move(round_arrivals));
+			labels.push_back(std::move(round_labels));
+		}
+		return rounds;
+	}
+
+}// router::
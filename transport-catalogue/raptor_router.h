@@ -0,0 +1,73 @@
+#pragma once
+
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace router {
+
+	// Поиск маршрута по раундам (в духе RAPTOR) прямо по последовательностям остановок автобусов,
+	// без построения графа. Раунд k находит лучшее время прибытия на остановки ровно с k посадками:
+	// каждый маршрут, проходящий через улучшенную в прошлом раунде остановку, просматривается один раз.
+	// Модель времени та же, что у графа: ожидание bus_wait_time при каждой посадке и езда со скоростью bus_velocity
+	class RaptorRouter {
+	public:
+		RaptorRouter(const transportcatalogue::TransportCatalogue& catalogue, RoutingSettings routing_settings);
+
+		std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>> BuildRoute(const Stop* from, const Stop* to,
+			const RouteClosures& closures, const RoutingProfile& profile) const;
+		// Маршруты в несколько остановок одним поиском: раунды останавливаются по самой поздней из них
+		std::vector<std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>>> BuildRoutes(const Stop* from,
+			const std::vector<const Stop*>& to, const RouteClosures& closures, const RoutingProfile& profile) const;
+		std::optional<SetRoute> BuildRouteBetweenSets(const std::vector<RouteEndpoint>& from, const std::vector<RouteEndpoint>& to,
+			const RouteClosures& closures, const RoutingProfile& profile) const;
+		// Остановки, до которых можно доехать не дольше max_time минут, со временем в пути, в порядке названий
+		std::vector<std::pair<Stop*, double>> FindReachableStops(const Stop* from, double max_time,
+			const RouteClosures& closures, const RoutingProfile& profile) const;
+
+	private:
+		using StopIndex = uint32_t;
+
+		// Направление движения автобуса: некольцевой маршрут дает два направления
+		struct RouteDirection {
+			const Bus* bus = nullptr;
+			std::vector<StopIndex> stops;
+			std::vector<int> distances; // расстояние от начала направления до остановки, м
+		};
+
+		// Как добрались до остановки в раунде: на каком направлении, от какой и до какой позиции
+		struct Label {
+			uint32_t direction = 0;
+			uint32_t board_position = 0;
+			uint32_t alight_position = 0;
+		};
+
+		// Результат раундов поиска из одной остановки
+		struct Rounds {
+			std::vector<std::vector<double>> arrivals; // arrivals[k][s] - лучшее время прибытия на остановку s ровно за k посадок
+			std::vector<std::vector<Label>> labels;
+			std::vector<double> best_arrivals;
+		};
+
+		static constexpr double INFINITE_TIME = std::numeric_limits<double>::infinity();
+
+		RoutingSettings routing_settings_;
+		std::vector<Stop*> stops_;
+		std::unordered_map<const Stop*, StopIndex> stop_index_;
+		std::vector<RouteDirection> directions_;
+		std::vector<std::vector<std::pair<uint32_t, uint32_t>>> stop_directions_; // (направление, позиция)
+
+		void AddDirection(const Bus* bus, std::vector<StopIndex> stops, std::vector<int> distances);
+		Rounds RunRounds(const std::vector<std::pair<StopIndex, double>>& sources, const std::vector<std::pair<StopIndex, double>>& targets,
+			bool is_any_target, double time_limit, const RouteClosures& closures, const RoutingProfile& profile) const;
+		std::pair<std::vector<IdEgeInfoForPrint>, StopIndex> ExtractRoute(const Rounds& rounds, StopIndex target,
+			const RoutingProfile& profile) const;
+	};
+
+}// router::
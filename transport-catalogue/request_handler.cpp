@@ -1,17 +1,27 @@
 #include "request_handler.h"
 
 void RequestHandler::Load(std::istream& in) {
+	startup_tasks_.WaitAll(); // документ может дополнить каталог, который читают задачи
 	json_reader_.Load(in);
+	router_service_.SetSettings(json_reader_.GetRoutingSettings());
+	startup_tasks_.Start(json_reader_.GetRenderSettings());
 }
 
 void RequestHandler::UploadAnswers(std::ostream& out){
 	json_reader_.GetAnswers(out);
 }
 
+const router::CreateGraphAndRoute& RequestHandler::GetRouter() {
+	return router_service_.GetRouter();
+}
+
 const std::optional<BusInfo> RequestHandler::GetBusStat(const std::string_view bus_name) const {
 	if (!catalogue_.FindsBus(bus_name)) {
 		return std::nullopt;
 	}
+	if (const auto prepared_stat = startup_tasks_.FindBusInfo(bus_name)) {
+		return prepared_stat;
+	}
 	return catalogue_.GetBusInfo(bus_name);
 }
 
@@ -25,6 +35,10 @@ const std::optional<std::vector<Bus*>> RequestHandler::GetBusesByStop(const std:
 void RequestHandler::RenderMap(std::ostream& out) {
 	using namespace std::literals;
 
+	if (const auto prepared_map = startup_tasks_.GetMap()) {
+		out << *prepared_map;
+		return;
+	}
 	renderer::Settings render_settings(json_reader_.GetRenderSettings());
 	renderer::MapRenderer map_renderer(render_settings);
 	map_renderer.DrawBuses(std::move(catalogue_.GetListAllBuses()), out);
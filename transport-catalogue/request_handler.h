@@ -4,17 +4,25 @@
 #include "json_reader.h"
 #include "map_renderer.h"
 #include "transport_router.h"
+#include "router_service.h"
+#include "startup_tasks.h"
 using namespace transportcatalogue;
 
 class RequestHandler {
     
 public:
     RequestHandler() = default;
-    RequestHandler(TransportCatalogue& catalogue) :catalogue_(catalogue), json_reader_(catalogue) { }
+    RequestHandler(TransportCatalogue& catalogue) :catalogue_(catalogue), router_service_(catalogue),
+        startup_tasks_(catalogue, router_service_), json_reader_(catalogue, router_service_, startup_tasks_) { }
 
+    // Загружает документ и сразу запускает подготовку карты, статистики автобусов и, при router_build = "eager",
+    // маршрутизатора; Load возвращается, не дожидаясь их
     void Load(std::istream& in);
     void UploadAnswers(std::ostream& out);
 
+    // Маршрутизатор каталога: ждет его построения, при router_build = "lazy" строит при первом вызове
+    const router::CreateGraphAndRoute& GetRouter();
+
     const std::optional<BusInfo> GetBusStat(const std::string_view bus_name) const;
     const std::optional<std::vector<Bus*>> GetBusesByStop(const std::string_view stop_name) const;
 
@@ -22,5 +30,7 @@ public:
 
 private:
     TransportCatalogue& catalogue_;
+    router::RouterService router_service_; // до startup_tasks_ и json_reader_: они хранят ссылки на него
+    StartupTasks startup_tasks_;
     JSONReader json_reader_;
 };
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "graph.h"
+#include "graph_diff.h"
+
+#include <optional>
+#include <vector>
+
+namespace graph {
+
+// Общий интерфейс алгоритмов поиска кратчайшего пути во взвешенном ориентированном графе
+template <typename Weight>
+class RouteEngine {
+public:
+    struct RouteInfo {
+        Weight weight;
+        std::vector<EdgeId> edges;
+    };
+
+    virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
+
+    // То же без выделения памяти: ребра пути в порядке пути записываются в edges вместо прежнего содержимого,
+    // вызывающий использует один буфер для многих запросов. nullopt - пути нет, иначе вес пути.
+    // Алгоритмы с готовыми таблицами или деревьями переопределяют метод, остальные копируют ребра BuildRoute
+    virtual std::optional<Weight> BuildRouteEdges(VertexId from, VertexId to, std::vector<EdgeId>& edges) const {
+        auto route = BuildRoute(from, to);
+        if (!route) {
+            return std::nullopt;
+        }
+        edges.assign(route->edges.begin(), route->edges.end());
+        return route->weight;
+    }
+
+    // Маршруты из одной вершины во все вершины targets, в том же порядке. Алгоритмы, которые строят
+    // дерево из начальной вершины, переопределяют метод, чтобы строить его один раз на все маршруты
+    virtual std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const {
+        std::vector<std::optional<RouteInfo>> routes;
+        routes.reserve(targets.size());
+        for (const VertexId to : targets) {
+            routes.push_back(BuildRoute(from, to));
+        }
+        return routes;
+    }
+
+    // Граф, по которому ищет алгоритм, заменен графом с теми же вершинами, diff - отличия от прежнего.
+    // true - данные поиска восстановлены, false - алгоритм нужно построить заново
+    virtual bool UpdateGraph(const GraphDiff<Weight>& /*diff*/) {
+        return false;
+    }
+
+    virtual ~RouteEngine() = default;
+};
+
+}  // namespace graph
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "graph.h"
+#include "route_engine.h"
+#include "weight_traits.h"
 
 #include <algorithm>
 #include <cassert>
@@ -15,19 +17,17 @@
 namespace graph {
 
 template <typename Weight>
-class Router {
+class Router : public RouteEngine<Weight> {
 private:
     using Graph = DirectedWeightedGraph<Weight>;
 
 public:
-    explicit Router(const Graph& graph);
+    using RouteInfo = typename RouteEngine<Weight>::RouteInfo;
 
-    struct RouteInfo {
-        Weight weight;
-        std::vector<EdgeId> edges;
-    };
+    explicit Router(const Graph& graph);
 
-    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    std::optional<Weight> BuildRouteEdges(VertexId from, VertexId to, std::vector<EdgeId>& edges) const override;
 
 private:
     struct RouteInternalData {
@@ -75,7 +75,7 @@ private:
         }
     }
 
-    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight ZERO_WEIGHT = WeightTraits<Weight>::ZERO;
     const Graph& graph_;
     RoutesInternalData routes_internal_data_;
 };
@@ -97,12 +97,21 @@ Router<Weight>::Router(const Graph& graph)
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
+    std::vector<EdgeId> edges;
+    const auto weight = BuildRouteEdges(from, to, edges);
+    if (!weight) {
+        return std::nullopt;
+    }
+    return RouteInfo{*weight, std::move(edges)};
+}
+
+template <typename Weight>
+std::optional<Weight> Router<Weight>::BuildRouteEdges(VertexId from, VertexId to, std::vector<EdgeId>& edges) const {
     const auto& route_internal_data = routes_internal_data_.at(from).at(to);
     if (!route_internal_data) {
         return std::nullopt;
     }
-    const Weight weight = route_internal_data->weight;
-    std::vector<EdgeId> edges;
+    edges.clear();
     for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
          edge_id;
          edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
@@ -110,8 +119,7 @@ std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(Ver
         edges.push_back(*edge_id);
     }
     std::reverse(edges.begin(), edges.end());
-
-    return RouteInfo{weight, std::move(edges)};
+    return route_internal_data->weight;
 }
 
 }  // namespace graph
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "router_service.h"
+
+namespace router {
+
+	RouterService::RouterService(transportcatalogue::TransportCatalogue& catalogue)
+		:catalogue_(catalogue) {
+	}
+
+	// Настройки меняет только этот метод, поэтому сравнение - без блокировки: оно не ждет маршрутизатор,
+	// который строится в другом потоке
+	void RouterService::SetSettings(const RoutingSettings& routing_settings) {
+		if (routing_settings == routing_settings_) {
+			return;
+		}
+		std::lock_guard guard(mutex_);
+		routing_settings_ = routing_settings;
+		router_u_ptr_.reset();
+	}
+
+	const RoutingSettings& RouterService::GetSettings() const {
+		return routing_settings_;
+	}
+
+	void RouterService::Prepare() {
+		std::lock_guard guard(mutex_);
+		PrepareLocked();
+	}
+
+	const CreateGraphAndRoute& RouterService::GetRouter() {
+		std::lock_guard guard(mutex_);
+		PrepareLocked();
+		return *router_u_ptr_;
+	}
+
+	bool RouterService::IsBuilt() const {
+		std::lock_guard guard(mutex_);
+		return router_u_ptr_ != nullptr;
+	}
+
+	// Изменения каталога с прошлого вызова обрабатываются одним обновлением маршрутизатора
+	void RouterService::PrepareLocked() {
+		const uint64_t version = catalogue_.GetVersion();
+		if (!router_u_ptr_) {
+			router_u_ptr_ = std::make_unique<CreateGraphAndRoute>(catalogue_, routing_settings_);
+		}
+		else if (router_version_ != version) {
+			router_u_ptr_->Update();
+		}
+		router_version_ = version;
+	}
+
+}// router::
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace router {
+
+	// Маршрутизатор одного каталога на все документы с запросами. Строится при первом запросе или заранее
+	// (Prepare), после изменения каталога обновляется при следующем запросе, при других настройках
+	// маршрутизации строится заново
+	class RouterService {
+	public:
+		explicit RouterService(transportcatalogue::TransportCatalogue& catalogue);
+
+		// Настройки из очередного документа; прежний маршрутизатор сохраняется, если они не изменились
+		void SetSettings(const RoutingSettings& routing_settings);
+		const RoutingSettings& GetSettings() const;
+
+		// Строит маршрутизатор сейчас, чтобы время построения не попало в ответ на первый запрос
+		void Prepare();
+
+		// Маршрутизатор по текущим данным каталога. Не вызывается одновременно с изменением каталога
+		const CreateGraphAndRoute& GetRouter();
+
+		bool IsBuilt() const;
+
+	private:
+		transportcatalogue::TransportCatalogue& catalogue_;
+		RoutingSettings routing_settings_;
+		std::unique_ptr<CreateGraphAndRoute> router_u_ptr_;
+		uint64_t router_version_ = 0; // версия каталога, по которой построен или обновлен маршрутизатор
+		mutable std::mutex mutex_;
+
+		void PrepareLocked();
+	};
+
+}// router::
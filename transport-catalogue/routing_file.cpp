@@ -0,0 +1,258 @@
+#include "routing_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace router {
+
+	namespace routing_file {
+
+		static_assert(std::is_trivially_copyable_v<Header>);
+		static_assert(std::is_trivially_copyable_v<Edge>);
+		static_assert(std::is_trivially_copyable_v<EdgeInfo>);
+		static_assert(std::is_trivially_copyable_v<graph::CompactRouteCell>);
+
+		namespace {
+
+			constexpr uint64_t ALIGNMENT = 8;
+
+			uint64_t AlignUp(uint64_t offset) {
+				return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+			}
+
+			template <typename Item>
+			void WriteArray(std::ofstream& out, uint64_t offset, const Item* items, size_t count) {
+				static const char zeros[ALIGNMENT] = {};
+				const auto position = static_cast<uint64_t>(out.tellp());
+				out.write(zeros, static_cast<std::streamsize>(offset - position));
+				out.write(reinterpret_cast<const char*>(items), static_cast<std::streamsize>(count * sizeof(Item)));
+			}
+
+			// массив count элементов по смещению offset целиком лежит в файле и выровнен
+			template <typename Item>
+			bool IsArrayInFile(uint64_t offset, uint64_t count, size_t file_size) {
+				return offset % alignof(Item) == 0 && offset <= file_size && count <= (file_size - offset) / sizeof(Item);
+			}
+
+		} // namespace
+
+		bool Save(const std::string& path, const Contents& contents) {
+			Header header{};
+			std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+			header.version = VERSION;
+			header.header_size = sizeof(Header);
+			header.fingerprint = contents.fingerprint;
+			header.stop_count = contents.stop_vertices.size();
+			header.bus_count = contents.bus_count;
+			header.vertex_count = contents.vertex_count;
+			header.edge_count = contents.edges.size();
+			header.stop_vertices_offset = AlignUp(sizeof(Header));
+			header.edges_offset = AlignUp(header.stop_vertices_offset + contents.stop_vertices.size() * sizeof(uint32_t));
+			header.edge_infos_offset = AlignUp(header.edges_offset + contents.edges.size() * sizeof(Edge));
+			header.routes_offset = AlignUp(header.edge_infos_offset + contents.edge_infos.size() * sizeof(EdgeInfo));
+
+			// запись во временный файл и переименование: другие процессы не увидят файл записанным наполовину
+			const std::string temp_path = path + ".tmp";
+			{
+				std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+				if (!out) {
+					return false;
+				}
+				out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+				WriteArray(out, header.stop_vertices_offset, contents.stop_vertices.data(), contents.stop_vertices.size());
+				WriteArray(out, header.edges_offset, contents.edges.data(), contents.edges.size());
+				WriteArray(out, header.edge_infos_offset, contents.edge_infos.data(), contents.edge_infos.size());
+				WriteArray(out, header.routes_offset, contents.routes->data(), contents.routes->size());
+				if (!out.flush()) {
+					return false;
+				}
+			}
+			std::error_code error;
+			std::filesystem::rename(temp_path, path, error);
+			return !error;
+		}
+
+	} // routing_file::
+
+	std::unique_ptr<MappedFile> MappedFile::Open(const std::string& path) {
+		std::unique_ptr<MappedFile> file(new MappedFile());
+#ifdef _WIN32
+		HANDLE file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file_handle == INVALID_HANDLE_VALUE) {
+			return nullptr;
+		}
+		file->file_handle_ = file_handle;
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file_handle, &size) || size.QuadPart == 0) {
+			return nullptr;
+		}
+		file->mapping_handle_ = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (file->mapping_handle_ == nullptr) {
+			return nullptr;
+		}
+		file->data_ = static_cast<const char*>(MapViewOfFile(file->mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+		if (file->data_ == nullptr) {
+			return nullptr;
+		}
+		file->size_ = static_cast<size_t>(size.QuadPart);
+#else
+		const int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return nullptr;
+		}
+		struct stat file_stat {};
+		if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+			close(fd);
+			return nullptr;
+		}
+		void* data = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (data == MAP_FAILED) {
+			return nullptr;
+		}
+		file->data_ = static_cast<const char*>(data);
+		file->size_ = static_cast<size_t>(file_stat.st_size);
+#endif
+		return file;
+	}
+
+	MappedFile::~MappedFile() {
+#ifdef _WIN32
+		if (data_ != nullptr) {
+			UnmapViewOfFile(data_);
+		}
+		if (mapping_handle_ != nullptr) {
+			CloseHandle(mapping_handle_);
+		}
+		if (file_handle_ != nullptr) {
+			CloseHandle(file_handle_);
+		}
+#else
+		if (data_ != nullptr) {
+			munmap(const_cast<char*>(data_), size_);
+		}
+#endif
+	}
+
+	const char* MappedFile::GetData() const {
+		return data_;
+	}
+
+	size_t MappedFile::GetSize() const {
+		return size_;
+	}
+
+	std::unique_ptr<MappedRoutes> MappedRoutes::Open(const std::string& path, uint64_t fingerprint,
+		const transportcatalogue::TransportCatalogue& catalogue) {
+		using namespace routing_file;
+
+		std::unique_ptr<MappedRoutes> routes(new MappedRoutes());
+		routes->file_ = MappedFile::Open(path);
+		if (!routes->file_ || routes->file_->GetSize() < sizeof(Header)) {
+			return nullptr;
+		}
+		const char* data = routes->file_->GetData();
+		const size_t size = routes->file_->GetSize();
+		const Header& header = *reinterpret_cast<const Header*>(data);
+		if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION
+			|| header.header_size != sizeof(Header) || header.fingerprint != fingerprint) {
+			return nullptr;
+		}
+
+		routes->stops_ = catalogue.GetListPtrAllStops();
+		std::sort(routes->stops_.begin(), routes->stops_.end(), [](const Stop* lhs, const Stop* rhs) { return lhs->stop_name < rhs->stop_name; });
+		routes->buses_ = catalogue.GetListAllBuses();
+		const uint64_t vertex_count = header.vertex_count;
+		if (header.stop_count != routes->stops_.size() || header.bus_count != routes->buses_.size()
+			|| vertex_count > UINT32_MAX
+			|| !IsArrayInFile<uint32_t>(header.stop_vertices_offset, header.stop_count, size)
+			|| !IsArrayInFile<Edge>(header.edges_offset, header.edge_count, size)
+			|| !IsArrayInFile<EdgeInfo>(header.edge_infos_offset, header.edge_count, size)
+			|| !IsArrayInFile<graph::CompactRouteCell>(header.routes_offset, vertex_count * vertex_count, size)) {
+			return nullptr;
+		}
+		routes->header_ = &header;
+		routes->stop_vertices_ = reinterpret_cast<const uint32_t*>(data + header.stop_vertices_offset);
+		routes->edges_ = reinterpret_cast<const Edge*>(data + header.edges_offset);
+		routes->edge_infos_ = reinterpret_cast<const EdgeInfo*>(data + header.edge_infos_offset);
+		routes->routes_ = reinterpret_cast<const graph::CompactRouteCell*>(data + header.routes_offset);
+
+		// проверяются все индексы, кроме ячеек таблицы: их слишком много, ребра ячеек проверяются при запросе
+		for (uint64_t i = 0; i < header.stop_count; ++i) {
+			if (routes->stop_vertices_[i] >= vertex_count) {
+				return nullptr;
+			}
+			routes->stop_index_[routes->stops_[i]] = static_cast<uint32_t>(i);
+		}
+		for (uint64_t i = 0; i < header.edge_count; ++i) {
+			const Edge& edge = routes->edges_[i];
+			const EdgeInfo& info = routes->edge_infos_[i];
+			if (edge.from >= vertex_count || edge.to >= vertex_count
+				|| (info.bus != NO_INDEX && info.bus >= header.bus_count)
+				|| (info.stop != NO_INDEX && info.stop >= header.stop_count)) {
+				return nullptr;
+			}
+		}
+		return routes;
+	}
+
+	std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>> MappedRoutes::BuildRoute(const Stop* from, const Stop* to) const {
+		RouteItemCollector collector;
+		const std::optional<double> total_time = VisitRoute(from, to, collector);
+		if (!total_time) {
+			return {};
+		}
+		return std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>> {std::pair{ std::move(collector.items), *total_time }};
+	}
+
+	// Ребра пути читаются от конца к началу, поэтому сначала записываются в буфер потока,
+	// который переиспользуется между запросами
+	std::optional<double> MappedRoutes::VisitRoute(const Stop* from, const Stop* to, RouteItemVisitor& visitor) const {
+		using namespace routing_file;
+
+		const uint64_t vertex_count = header_->vertex_count;
+		const uint32_t vertex_from = stop_vertices_[stop_index_.at(from)];
+		const uint32_t vertex_to = stop_vertices_[stop_index_.at(to)];
+		const graph::CompactRouteCell* row = routes_ + vertex_from * vertex_count;
+		if (row[vertex_to].weight == graph::CompactRouter<double>::UNREACHABLE) {
+			return std::nullopt;
+		}
+
+		thread_local std::vector<uint32_t> edges;
+		edges.clear();
+		for (uint32_t edge_id = row[vertex_to].prev_edge; edge_id != graph::CompactRouter<double>::NO_EDGE;
+			edge_id = row[edges_[edge_id].from].prev_edge) {
+			if (edge_id >= header_->edge_count || edges.size() >= vertex_count) {
+				throw std::runtime_error("Routing file is corrupted");
+			}
+			edges.push_back(edge_id);
+		}
+
+		RouteItemCollapser collapser(visitor);
+		double total_time = 0;
+		for (auto it_edge = edges.rbegin(); it_edge != edges.rend(); ++it_edge) {
+			total_time += edges_[*it_edge].weight;
+			const EdgeInfo& info = edge_infos_[*it_edge];
+			if (info.bus == NO_INDEX && info.stop == NO_INDEX) { continue; }
+			collapser.Add({ info.bus == NO_INDEX ? nullptr : buses_[info.bus],
+				info.stop == NO_INDEX ? nullptr : stops_[info.stop], static_cast<int>(info.span), info.weight });
+		}
+		collapser.Finish();
+		return total_time;
+	}
+
+}// router::
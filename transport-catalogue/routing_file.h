@@ -0,0 +1,121 @@
+#pragma once
+
+#include "compact_router.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace router {
+
+	// Файл с построенными структурами маршрутизации. Все ссылки внутри файла - смещения от его начала,
+	// остановки и автобусы - индексы в порядке названий, поэтому файл не зависит от адресов процесса.
+	// Формат: заголовок, номера вершин остановок, ребра, данные ребер для вывода, компактная таблица всех пар
+	namespace routing_file {
+
+		inline constexpr char MAGIC[8] = { 'T', 'C', 'R', 'O', 'U', 'T', 'E', '\0' };
+		inline constexpr uint32_t VERSION = 2; // 2: таблица считается в порядке Флойда-Уоршелла, как в Router
+		inline constexpr uint32_t NO_INDEX = UINT32_MAX;
+
+		struct Header {
+			char magic[8];
+			uint32_t version;
+			uint32_t header_size;
+			uint64_t fingerprint; // хеш данных каталога и настроек, из которых построен файл
+			uint64_t stop_count;
+			uint64_t bus_count;
+			uint64_t vertex_count;
+			uint64_t edge_count;
+			uint64_t stop_vertices_offset; // uint32_t на каждую остановку
+			uint64_t edges_offset;         // Edge на каждое ребро
+			uint64_t edge_infos_offset;    // EdgeInfo на каждое ребро
+			uint64_t routes_offset;        // graph::CompactRouteCell на каждую пару вершин
+		};
+
+		struct Edge {
+			uint32_t from;
+			uint32_t to;
+			double weight;
+		};
+
+		// Данные ребра для вывода; bus == stop == NO_INDEX - ребро не выводится (выход из автобуса)
+		struct EdgeInfo {
+			uint32_t bus;
+			uint32_t stop;
+			uint32_t span;
+			uint32_t reserved;
+			double weight;
+		};
+
+		struct Contents {
+			uint64_t fingerprint = 0;
+			std::vector<uint32_t> stop_vertices;
+			std::vector<Edge> edges;
+			std::vector<EdgeInfo> edge_infos;
+			size_t bus_count = 0;
+			size_t vertex_count = 0;
+			const std::vector<graph::CompactRouteCell>* routes = nullptr;
+		};
+
+		// false, если файл не удалось записать
+		bool Save(const std::string& path, const Contents& contents);
+
+	} // routing_file::
+
+	// Файл, отображенный в память только для чтения
+	class MappedFile {
+	public:
+		// nullptr, если файл не открывается
+		static std::unique_ptr<MappedFile> Open(const std::string& path);
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile();
+
+		const char* GetData() const;
+		size_t GetSize() const;
+
+	private:
+		MappedFile() = default;
+
+		const char* data_ = nullptr;
+		size_t size_ = 0;
+#ifdef _WIN32
+		void* file_handle_ = nullptr;
+		void* mapping_handle_ = nullptr;
+#endif
+	};
+
+	// Ответы на запросы маршрута прямо из отображенного файла, без десериализации таблиц
+	class MappedRoutes {
+	public:
+		// nullptr, если файла нет, он другой версии, поврежден или построен по другим данным
+		static std::unique_ptr<MappedRoutes> Open(const std::string& path, uint64_t fingerprint,
+			const transportcatalogue::TransportCatalogue& catalogue);
+
+		std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>> BuildRoute(const Stop* from, const Stop* to) const;
+		// Элементы маршрута по одному, без выделения памяти на запрос; возвращает total_time
+		std::optional<double> VisitRoute(const Stop* from, const Stop* to, RouteItemVisitor& visitor) const;
+
+	private:
+		MappedRoutes() = default;
+
+		std::unique_ptr<MappedFile> file_;
+		const routing_file::Header* header_ = nullptr;
+		const uint32_t* stop_vertices_ = nullptr;
+		const routing_file::Edge* edges_ = nullptr;
+		const routing_file::EdgeInfo* edge_infos_ = nullptr;
+		const graph::CompactRouteCell* routes_ = nullptr;
+
+		std::vector<Stop*> stops_;
+		std::vector<Bus*> buses_;
+		std::unordered_map<const Stop*, uint32_t> stop_index_;
+	};
+
+}// router::
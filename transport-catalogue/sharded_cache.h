@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace concurrency {
+
+	// Ограниченный кеш, разбитый на независимые части (шарды) со своей блокировкой. Вытеснение - CLOCK:
+	// чтение только отмечает запись, поэтому читатели одного шарда работают одновременно под общей блокировкой.
+	// Запись хранит версию данных, из которых получено значение; запись другой версии считается промахом
+	template <typename Key, typename Value, typename Hash = std::hash<Key>>
+	class ShardedClockCache {
+	public:
+		struct Stats {
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			uint64_t evictions = 0;
+		};
+
+		static constexpr size_t DEFAULT_SHARD_COUNT = 16;
+
+		// capacity == 0 - кеш ничего не хранит; shard_count округляется вверх до степени двойки
+		explicit ShardedClockCache(size_t capacity, size_t shard_count = DEFAULT_SHARD_COUNT);
+
+		std::optional<Value> Get(const Key& key, uint64_t version) const;
+		void Put(const Key& key, Value value, uint64_t version);
+
+		size_t GetCapacity() const {
+			return capacity_;
+		}
+		Stats GetStats() const;
+
+	private:
+		struct Slot {
+			Key key{};
+			Value value{};
+			uint64_t version = 0;
+			bool is_used = false;
+			mutable std::atomic<bool> is_referenced{ false };
+		};
+
+		struct Shard {
+			mutable std::shared_mutex mutex;
+			std::vector<Slot> slots;
+			std::unordered_map<Key, size_t, Hash> slot_by_key;
+			size_t hand = 0;
+			mutable std::atomic<uint64_t> hits{ 0 };
+			mutable std::atomic<uint64_t> misses{ 0 };
+			std::atomic<uint64_t> evictions{ 0 };
+		};
+
+		Shard& GetShard(const Key& key) const;
+
+		const size_t capacity_;
+		size_t shard_bits_ = 0;
+		std::unique_ptr<Shard[]> shards_;
+	};
+
+	template <typename Key, typename Value, typename Hash>
+	ShardedClockCache<Key, Value, Hash>::ShardedClockCache(size_t capacity, size_t shard_count)
+		: capacity_(capacity) {
+		while ((size_t{ 1 } << shard_bits_) < shard_count) {
+			++shard_bits_;
+		}
+		shard_count = size_t{ 1 } << shard_bits_;
+		shards_ = std::make_unique<Shard[]>(shard_count);
+		// емкость делится между шардами, первые получают остаток
+		for (size_t i = 0; i < shard_count; ++i) {
+			shards_[i].slots = std::vector<Slot>(capacity / shard_count + (i < capacity % shard_count ? 1 : 0));
+		}
+	}
+
+	// Шард по старшим битам перемешанного хеша: внутри шарда хеш-таблица использует тот же хеш
+	template <typename Key, typename Value, typename Hash>
+	typename ShardedClockCache<Key, Value, Hash>::Shard& ShardedClockCache<Key, Value, Hash>::GetShard(const Key& key) const {
+		if (shard_bits_ == 0) {
+			return shards_[0];
+		}
+		const uint64_t mixed = static_cast<uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+		return shards_[mixed >> (64 - shard_bits_)];
+	}
+
+	template <typename Key, typename Value, typename Hash>
+	std::optional<Value> ShardedClockCache<Key, Value, Hash>::Get(const Key& key, uint64_t version) const {
+		Shard& shard = GetShard(key);
+		std::shared_lock lock(shard.mutex);
+		const auto it = shard.slot_by_key.find(key);
+		if (it == shard.slot_by_key.end() || shard.slots[it->second].version != version) {
+			shard.misses.fetch_add(1, std::memory_order_relaxed);
+			return std::nullopt;
+		}
+		const Slot& slot = shard.slots[it->second];
+		slot.is_referenced.store(true, std::memory_order_relaxed);
+		shard.hits.fetch_add(1, std::memory_order_relaxed);
+		return slot.value;
+	}
+
+	// Стрелка обходит записи по кругу и снимает отметки; вытесняется первая запись без отметки
+	template <typename Key, typename Value, typename Hash>
+	void ShardedClockCache<Key, Value, Hash>::Put(const Key& key, Value value, uint64_t version) {
+		Shard& shard = GetShard(key);
+		if (shard.slots.empty()) {
+			return;
+		}
+		std::unique_lock lock(shard.mutex);
+		if (const auto it = shard.slot_by_key.find(key); it != shard.slot_by_key.end()) {
+			Slot& slot = shard.slots[it->second];
+			slot.value = std::move(value);
+			slot.version = version;
+			slot.is_referenced.store(true, std::memory_order_relaxed);
+			return;
+		}
+		while (shard.slots[shard.hand].is_used && shard.slots[shard.hand].is_referenced.exchange(false, std::memory_order_relaxed)) {
+			shard.hand = (shard.hand + 1) % shard.slots.size();
+		}
+		Slot& slot = shard.slots[shard.hand];
+		if (slot.is_used) {
+			shard.slot_by_key.erase(slot.key);
+			shard.evictions.fetch_add(1, std::memory_order_relaxed);
+		}
+		slot.key = key;
+		slot.value = std::move(value);
+		slot.version = version;
+		slot.is_used = true;
+		slot.is_referenced.store(false, std::memory_order_relaxed);
+		shard.slot_by_key[key] = shard.hand;
+		shard.hand = (shard.hand + 1) % shard.slots.size();
+	}
+
+	template <typename Key, typename Value, typename Hash>
+	typename ShardedClockCache<Key, Value, Hash>::Stats ShardedClockCache<Key, Value, Hash>::GetStats() const {
+		Stats stats;
+		for (size_t i = 0; i < (size_t{ 1 } << shard_bits_); ++i) {
+			stats.hits += shards_[i].hits.load(std::memory_order_relaxed);
+			stats.misses += shards_[i].misses.load(std::memory_order_relaxed);
+			stats.evictions += shards_[i].evictions.load(std::memory_order_relaxed);
+		}
+		return stats;
+	}
+
+} // concurrency::
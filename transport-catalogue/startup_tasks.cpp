@@ -0,0 +1,69 @@
+#include "startup_tasks.h"
+
+#include <sstream>
+
+StartupTasks::StartupTasks(transportcatalogue::TransportCatalogue& catalogue, router::RouterService& router_service)
+	: catalogue_(catalogue)
+	, router_service_(router_service)
+	, pool_(THREAD_COUNT) {
+}
+
+StartupTasks::~StartupTasks() {
+	WaitAll();
+}
+
+// Задачи только читают каталог и друг от друга не зависят; маршрутизатор строится под блокировкой
+// RouterService, поэтому запрос маршрута сам дождется его построения
+void StartupTasks::Start(const renderer::Settings& render_settings) {
+	WaitAll();
+	tasks_ = std::make_unique<concurrency::TaskGraph>(pool_);
+	version_ = catalogue_.GetVersion();
+
+	if (router_service_.GetSettings().router_build == router::RouterBuild::EAGER) {
+		tasks_->AddTask([this]() {
+			router_service_.Prepare();
+		});
+	}
+
+	map_.clear();
+	map_task_ = tasks_->AddTask([this, render_settings]() {
+		std::ostringstream out;
+		renderer::MapRenderer map_renderer(render_settings);
+		map_renderer.DrawBuses(catalogue_.GetListAllBuses(), out);
+		map_ = out.str();
+	});
+
+	bus_stats_.clear();
+	is_bus_stats_ready_ = false;
+	bus_stats_task_ = tasks_->AddTask([this]() {
+		for (const transportcatalogue::Bus* ptr_bus : catalogue_.GetListAllBuses()) {
+			bus_stats_[ptr_bus->bus_name] = catalogue_.GetBusInfo(ptr_bus->bus_name);
+		}
+		is_bus_stats_ready_ = true;
+	});
+}
+
+void StartupTasks::WaitAll() {
+	if (tasks_) {
+		tasks_->WaitAll();
+	}
+}
+
+std::optional<transportcatalogue::BusInfo> StartupTasks::FindBusInfo(std::string_view bus_name) const {
+	if (!bus_stats_task_ || !tasks_->IsDone(*bus_stats_task_) || !is_bus_stats_ready_ || catalogue_.GetVersion() != version_) {
+		return std::nullopt;
+	}
+	const auto it_stat = bus_stats_.find(bus_name);
+	if (it_stat == bus_stats_.end()) {
+		return std::nullopt;
+	}
+	return it_stat->second;
+}
+
+std::optional<std::string> StartupTasks::GetMap() const {
+	if (!map_task_ || catalogue_.GetVersion() != version_) {
+		return std::nullopt;
+	}
+	tasks_->Wait(*map_task_);
+	return map_;
+}
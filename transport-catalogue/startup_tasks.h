@@ -0,0 +1,52 @@
+#pragma once
+
+#include "domain.h"
+#include "map_renderer.h"
+#include "router_service.h"
+#include "task_graph.h"
+#include "thread_pool.h"
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Подготовка после загрузки документа: маршрутизатор (при router_build = "eager"), SVG карты и статистика
+// автобусов строятся параллельно. Запросы Stop и Bus отвечаются сразу, запрос ждет только то, что ему нужно.
+// Результаты помечены версией каталога и после его изменения не используются
+class StartupTasks {
+public:
+	StartupTasks(transportcatalogue::TransportCatalogue& catalogue, router::RouterService& router_service);
+	StartupTasks(const StartupTasks&) = delete;
+	StartupTasks& operator=(const StartupTasks&) = delete;
+	// Дожидается задач: они пишут в поля ниже, которые разрушаются раньше tasks_
+	~StartupTasks();
+
+	// Начинает подготовку по текущим данным каталога; прежние задачи сначала завершаются
+	void Start(const renderer::Settings& render_settings);
+	// Дожидается всех задач; вызывается перед изменением каталога, который задачи читают
+	void WaitAll();
+
+	// Статистика автобуса, если она уже посчитана по текущей версии каталога; не ждет
+	std::optional<transportcatalogue::BusInfo> FindBusInfo(std::string_view bus_name) const;
+	// SVG карты по текущей версии каталога, ждет задачу карты; nullopt - карта не готовилась или устарела
+	std::optional<std::string> GetMap() const;
+
+private:
+	static constexpr size_t THREAD_COUNT = 3; // по задаче на каждый результат, маршрутизатор строится своим пулом
+
+	transportcatalogue::TransportCatalogue& catalogue_;
+	router::RouterService& router_service_;
+	concurrency::ThreadPool pool_;
+	std::unique_ptr<concurrency::TaskGraph> tasks_;
+	uint64_t version_ = 0; // версия каталога, по которой готовятся результаты
+
+	std::optional<concurrency::TaskGraph::TaskId> map_task_;
+	std::string map_;
+	std::optional<concurrency::TaskGraph::TaskId> bus_stats_task_;
+	std::unordered_map<std::string_view, transportcatalogue::BusInfo> bus_stats_;
+	bool is_bus_stats_ready_ = false; // задача статистики завершилась без ошибки
+};
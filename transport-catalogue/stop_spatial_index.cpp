@@ -0,0 +1,89 @@
+#define _USE_MATH_DEFINES
+#include "stop_spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace transportcatalogue {
+
+	namespace {
+		// длина градуса широты при радиусе Земли из ComputeDistance
+		constexpr double METERS_PER_DEGREE = 6371000 * 3.1415926535 / 180.;
+		// запас на то, что дуга большого круга короче пути вдоль параллели
+		constexpr double LNG_MARGIN = 1.1;
+		// ближе к полюсу градус долготы слишком короток для сетки, просматриваются все ячейки по долготе
+		constexpr double MIN_COS_LAT = 0.01;
+	}
+
+	StopSpatialIndex::StopSpatialIndex(const std::vector<Stop*>& stops, double cell_size) {
+		if (stops.empty()) { return; }
+		double sum_lat = 0;
+		for (const Stop* ptr_stop : stops) {
+			sum_lat += ptr_stop->coordinates.lat;
+		}
+		const double cos_lat = std::max(std::cos(sum_lat / stops.size() * M_PI / 180.), MIN_COS_LAT);
+		cell_lat_ = cell_size / METERS_PER_DEGREE;
+		cell_lng_ = cell_lat_ / cos_lat;
+		for (Stop* ptr_stop : stops) {
+			cells_[GetCellKey(GetCellLat(ptr_stop->coordinates.lat), GetCellLng(ptr_stop->coordinates.lng))].push_back(ptr_stop);
+		}
+	}
+
+	std::vector<std::pair<Stop*, double>> StopSpatialIndex::FindStopsWithin(detail::Coordinates point, double radius) const {
+		std::vector<std::pair<Stop*, double>> found_stops;
+		const auto add_stops = [&found_stops, point, radius](const std::vector<Stop*>& stops) {
+			for (Stop* ptr_stop : stops) {
+				const double distance = detail::ComputeDistance(point, ptr_stop->coordinates);
+				if (distance <= radius) {
+					found_stops.push_back({ ptr_stop, distance });
+				}
+			}
+		};
+
+		if (cells_.empty()) {
+			return found_stops;
+		}
+		const double delta_lat = radius / METERS_PER_DEGREE;
+		const double max_abs_lat = std::min(std::max(std::abs(point.lat - delta_lat), std::abs(point.lat + delta_lat)), 90.);
+		const double cos_lat = std::cos(max_abs_lat * M_PI / 180.);
+		const double delta_lng = cos_lat < MIN_COS_LAT ? 360. : LNG_MARGIN * radius / (METERS_PER_DEGREE * cos_lat);
+		const int64_t min_cell_lat = GetCellLat(point.lat - delta_lat);
+		const int64_t max_cell_lat = GetCellLat(point.lat + delta_lat);
+		const int64_t min_cell_lng = GetCellLng(point.lng - delta_lng);
+		const int64_t max_cell_lng = GetCellLng(point.lng + delta_lng);
+		if ((max_cell_lat - min_cell_lat + 1) * (max_cell_lng - min_cell_lng + 1) > static_cast<int64_t>(cells_.size())
+			|| point.lng - delta_lng < -180. || point.lng + delta_lng > 180.) {
+			// квадрат поиска покрывает больше ячеек, чем занято остановками, или переходит через 180-й меридиан:
+			// просматриваются все
+			for (const auto& [key, stops] : cells_) {
+				add_stops(stops);
+			}
+		}
+		else {
+			for (int64_t cell_lat = min_cell_lat; cell_lat <= max_cell_lat; ++cell_lat) {
+				for (int64_t cell_lng = min_cell_lng; cell_lng <= max_cell_lng; ++cell_lng) {
+					if (const auto it = cells_.find(GetCellKey(static_cast<int32_t>(cell_lat), static_cast<int32_t>(cell_lng))); it != cells_.end()) {
+						add_stops(it->second);
+					}
+				}
+			}
+		}
+		std::sort(found_stops.begin(), found_stops.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.second < rhs.second || (lhs.second == rhs.second && lhs.first->stop_name < rhs.first->stop_name);
+		});
+		return found_stops;
+	}
+
+	int32_t StopSpatialIndex::GetCellLat(double lat) const {
+		return static_cast<int32_t>(std::floor(lat / cell_lat_));
+	}
+
+	int32_t StopSpatialIndex::GetCellLng(double lng) const {
+		return static_cast<int32_t>(std::floor(lng / cell_lng_));
+	}
+
+	uint64_t StopSpatialIndex::GetCellKey(int32_t cell_lat, int32_t cell_lng) {
+		return (uint64_t(uint32_t(cell_lat)) << 32) | uint32_t(cell_lng);
+	}
+
+} // end transportcatalogue
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "domain.h"
+#include "geo.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace transportcatalogue {
+
+	// Сетка по координатам остановок: поиск остановок в радиусе от точки просматривает
+	// только ячейки, пересекающие квадрат вокруг круга поиска, а не все остановки
+	class StopSpatialIndex {
+	public:
+		static constexpr double DEFAULT_CELL_SIZE = 500; // м
+
+		StopSpatialIndex() = default;
+		explicit StopSpatialIndex(const std::vector<Stop*>& stops, double cell_size = DEFAULT_CELL_SIZE);
+
+		// Остановки не дальше radius метров от point и расстояние до них, по возрастанию расстояния
+		std::vector<std::pair<Stop*, double>> FindStopsWithin(detail::Coordinates point, double radius) const;
+
+	private:
+		double cell_lat_ = 0; // размер ячейки в градусах
+		double cell_lng_ = 0;
+		std::unordered_map<uint64_t, std::vector<Stop*>> cells_;
+
+		int32_t GetCellLat(double lat) const;
+		int32_t GetCellLng(double lng) const;
+		static uint64_t GetCellKey(int32_t cell_lat, int32_t cell_lng);
+	};
+
+} // end transportcatalogue
@@ -0,0 +1,132 @@
+#include "task_graph.h"
+
+#include <utility>
+
+namespace concurrency {
+
+	TaskGraph::TaskGraph(ThreadPool& pool)
+		: pool_(pool) {
+	}
+
+	TaskGraph::~TaskGraph() {
+		WaitAll();
+		// последняя задача могла выставить результат и еще не отпустить блокировку
+		std::lock_guard guard(mutex_);
+	}
+
+	TaskGraph::TaskId TaskGraph::AddTask(std::function<void()> task, const std::vector<TaskId>& dependencies) {
+		std::exception_ptr error;
+		TaskId task_id = 0;
+		{
+			std::lock_guard guard(mutex_);
+			task_id = nodes_.size();
+			Node& node = nodes_.emplace_back();
+			node.task = std::move(task);
+			node.future = node.promise.get_future().share();
+			for (const TaskId dependency : dependencies) {
+				Node& dependency_node = nodes_.at(dependency);
+				if (!dependency_node.is_done) {
+					dependency_node.dependents.push_back(task_id);
+					++node.remaining_dependencies;
+				}
+				else if (dependency_node.error && !error) {
+					error = dependency_node.error;
+				}
+			}
+			if (node.remaining_dependencies != 0) {
+				node.error = error;
+				return task_id;
+			}
+		}
+		if (error) {
+			Finish(task_id, error);
+		}
+		else {
+			pool_.Submit([this, task_id]() { Run(task_id); });
+		}
+		return task_id;
+	}
+
+	void TaskGraph::Wait(TaskId task_id) const {
+		std::shared_future<void> future;
+		{
+			std::lock_guard guard(mutex_);
+			future = nodes_.at(task_id).future;
+		}
+		future.get();
+	}
+
+	bool TaskGraph::IsDone(TaskId task_id) const {
+		std::lock_guard guard(mutex_);
+		return nodes_.at(task_id).is_done;
+	}
+
+	void TaskGraph::WaitAll() const {
+		std::vector<std::shared_future<void>> futures;
+		{
+			std::lock_guard guard(mutex_);
+			for (const Node& node : nodes_) {
+				futures.push_back(node.future);
+			}
+		}
+		for (const auto& future : futures) {
+			future.wait();
+		}
+	}
+
+	void TaskGraph::Run(TaskId task_id) {
+		std::function<void()> task;
+		{
+			std::lock_guard guard(mutex_);
+			task = std::move(nodes_[task_id].task);
+		}
+		std::exception_ptr error;
+		try {
+			task();
+		}
+		catch (...) {
+			error = std::current_exception();
+		}
+		Finish(task_id, error);
+	}
+
+	// Задачи, у которых не осталось невыполненных зависимостей, ставятся в очередь; после ошибки
+	// зависящие задачи завершаются той же ошибкой без выполнения
+	void TaskGraph::Finish(TaskId task_id, std::exception_ptr error) {
+		std::vector<TaskId> ready;
+		std::vector<TaskId> finished = { task_id };
+		{
+			std::lock_guard guard(mutex_);
+			nodes_[task_id].error = error;
+			for (size_t i = 0; i < finished.size(); ++i) {
+				Node& node = nodes_[finished[i]];
+				node.is_done = true;
+				if (node.error) {
+					node.promise.set_exception(node.error);
+				}
+				else {
+					node.promise.set_value();
+				}
+				for (const TaskId dependent : node.dependents) {
+					Node& dependent_node = nodes_[dependent];
+					if (node.error && !dependent_node.error) {
+						dependent_node.error = node.error;
+					}
+					if (--dependent_node.remaining_dependencies != 0) {
+						continue;
+					}
+					if (dependent_node.error) {
+						finished.push_back(dependent);
+					}
+					else {
+						ready.push_back(dependent);
+					}
+				}
+			}
+		}
+		for (const TaskId ready_id : ready) {
+			pool_.Submit([this, ready_id]() { Run(ready_id); });
+		}
+	}
+
+} // concurrency::
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <vector>
+
+namespace concurrency {
+
+	// Задачи с зависимостями в пуле потоков: задача ставится в очередь пула, как только выполнены все задачи,
+	// от которых она зависит. Зависимости - уже добавленные задачи, поэтому циклов не бывает.
+	// Если задача завершилась исключением, зависящие от нее не выполняются и Wait бросает то же исключение
+	class TaskGraph {
+	public:
+		using TaskId = size_t;
+
+		explicit TaskGraph(ThreadPool& pool);
+		TaskGraph(const TaskGraph&) = delete;
+		TaskGraph& operator=(const TaskGraph&) = delete;
+		// Дожидается всех задач: они могут ссылаться на данные владельца графа
+		~TaskGraph();
+
+		TaskId AddTask(std::function<void()> task, const std::vector<TaskId>& dependencies = {});
+
+		void Wait(TaskId task_id) const;
+		// Без ожидания: задача выполнена (или не будет выполнена из-за ошибки)
+		bool IsDone(TaskId task_id) const;
+		// Дожидается всех задач, исключения не бросает
+		void WaitAll() const;
+
+	private:
+		struct Node {
+			std::function<void()> task;
+			size_t remaining_dependencies = 0;
+			std::vector<TaskId> dependents;
+			std::exception_ptr error;
+			bool is_done = false;
+			std::promise<void> promise;
+			std::shared_future<void> future;
+		};
+
+		ThreadPool& pool_;
+		mutable std::mutex mutex_;
+		std::deque<Node> nodes_; // ссылки на элементы не меняются при добавлении задач
+
+		void Run(TaskId task_id);
+		void Finish(TaskId task_id, std::exception_ptr error);
+	};
+
+} // concurrency::
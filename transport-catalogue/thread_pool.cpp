@@ -0,0 +1,113 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace concurrency {
+
+	ThreadPool::ThreadPool(size_t thread_count) {
+		if (thread_count == 0) {
+			thread_count = std::max(1u, std::thread::hardware_concurrency());
+		}
+		workers_.reserve(thread_count);
+		for (size_t i = 0; i < thread_count; ++i) {
+			workers_.emplace_back([this]() { WorkerLoop(); });
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::lock_guard guard(mutex_);
+			stop_ = true;
+		}
+		cv_.notify_all();
+		for (auto& worker : workers_) {
+			worker.join();
+		}
+	}
+
+	size_t ThreadPool::GetThreadCount() const {
+		return workers_.size();
+	}
+
+	void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& func) {
+		if (count == 0) {
+			return;
+		}
+		struct State {
+			std::atomic<size_t> next_index{ 0 };
+			size_t done_count = 0;
+			std::exception_ptr error; // первое исключение func
+			std::mutex mutex;
+			std::condition_variable cv;
+		};
+		auto state = std::make_shared<State>();
+
+		// Итерации разбираются через общий счетчик, поэтому опоздавшая задача просто завершается,
+		// а вызывающий поток ждет только уже взятые в работу итерации. Итерация с исключением тоже считается
+		// выполненной: исключение сохраняется и бросается в вызывающем потоке, когда func больше нигде не выполняется
+		auto run = [state, count, &func]() {
+			size_t done = 0;
+			std::exception_ptr error;
+			for (size_t index = state->next_index++; index < count; index = state->next_index++) {
+				try {
+					func(index);
+				}
+				catch (...) {
+					if (!error) {
+						error = std::current_exception();
+					}
+				}
+				++done;
+			}
+			if (done != 0) {
+				std::lock_guard guard(state->mutex);
+				if (error && !state->error) {
+					state->error = error;
+				}
+				state->done_count += done;
+				if (state->done_count == count) {
+					state->cv.notify_all();
+				}
+			}
+		};
+
+		const size_t helpers = std::min(count, workers_.size()) - 1;
+		for (size_t i = 0; i < helpers; ++i) {
+			Enqueue(run);
+		}
+		run();
+
+		std::unique_lock lock(state->mutex);
+		state->cv.wait(lock, [&state, count]() { return state->done_count == count; });
+		if (state->error) {
+			std::rethrow_exception(state->error);
+		}
+	}
+
+	void ThreadPool::WorkerLoop() {
+		for (;;) {
+			std::function<void()> task;
+			{
+				std::unique_lock lock(mutex_);
+				cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+				if (stop_ && tasks_.empty()) {
+					return;
+				}
+				task = std::move(tasks_.front());
+				tasks_.pop();
+			}
+			task();
+		}
+	}
+
+	void ThreadPool::Enqueue(std::function<void()> task) {
+		{
+			std::lock_guard guard(mutex_);
+			tasks_.push(std::move(task));
+		}
+		cv_.notify_one();
+	}
+
+} // concurrency::
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace concurrency {
+
+	// Пул рабочих потоков с общей очередью задач
+	class ThreadPool {
+	public:
+		// thread_count == 0 - по числу аппаратных потоков
+		explicit ThreadPool(size_t thread_count = 0);
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		~ThreadPool();
+
+		size_t GetThreadCount() const;
+
+		template <typename Task>
+		std::future<std::invoke_result_t<Task>> Submit(Task task);
+
+		// Выполняет func(index) для каждого index из [0, count) и дожидается завершения.
+		// Вызывающий поток тоже выполняет итерации, поэтому вызов безопасен из задачи самого пула.
+		// Исключение из func бросается здесь после завершения всех итераций (первое, если их несколько)
+		void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+
+	private:
+		std::vector<std::thread> workers_;
+		std::queue<std::function<void()>> tasks_;
+		std::mutex mutex_;
+		std::condition_variable cv_;
+		bool stop_ = false;
+
+		void WorkerLoop();
+		void Enqueue(std::function<void()> task);
+	};
+
+	template <typename Task>
+	std::future<std::invoke_result_t<Task>> ThreadPool::Submit(Task task) {
+		using Result = std::invoke_result_t<Task>;
+		auto packaged_task = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+		std::future<Result> result = packaged_task->get_future();
+		Enqueue([packaged_task]() { (*packaged_task)(); });
+		return result;
+	}
+
+} // concurrency::
@@ -8,18 +8,19 @@ namespace transportcatalogue {
 	void TransportCatalogue::AddStop(const std::string& stop, const detail::Coordinates& coordinates) {
 		stops_.push_front({ std::move(stop), std::move(coordinates) });
 		stop_name_to_ptr_[stops_[0].stop_name] = &stops_[0];
+		++version_;
 	}
 
 	std::vector<Bus*> TransportCatalogue::GetListOfBusStops(std::string_view stop_name) const {
-		if (!FindStop(stop_name)) {
+		const Stop* ptr_stop = FindStop(stop_name);
+		if (!ptr_stop) {
 			return  {};
 		}
-		std::vector<Bus*> buses_list;
-		for (const auto& [bus_name, bus_stops, is_roundtrip] : buses_) {
-			if (std::find(bus_stops.begin(), bus_stops.end(), stop_name_to_ptr_.at(stop_name)) != bus_stops.end()) {
-				buses_list.push_back(buses_name_to_ptr_.at(bus_name));
-			}
+		const auto it_buses = stop_to_buses_.find(ptr_stop);
+		if (it_buses == stop_to_buses_.end()) {
+			return {};
 		}
+		std::vector<Bus*> buses_list = it_buses->second;
 		if (!buses_list.empty()) {
 			std::sort(buses_list.begin(), buses_list.end(), [](Bus* a, Bus* b) {return a->bus_name < b->bus_name; });
 		}
@@ -53,6 +54,10 @@ namespace transportcatalogue {
 		return stop_name_to_ptr_.size();
 	}
 
+	uint64_t TransportCatalogue::GetVersion() const {
+		return version_;
+	}
+
 	// начальная остановка для любых видов маршрутов и конечная для не кольцевого, всегда считаются двойными с расстоянием 0 по умолчанию
 	void TransportCatalogue::AddBus(const std::string& bus, const std::vector<std::string_view>& stops, const bool is_roundtrip) {
 		using namespace std::literals;
@@ -64,6 +69,29 @@ namespace transportcatalogue {
 			Stop* ptr_stop = stop_name_to_ptr_.at(stop_name);
 			buses_[0].bus_stops.push_back(ptr_stop);
 		}
+		AddBusToStops(&buses_[0]);
+		CalculationRouteDistances(&buses_[0]);
+		++version_;
+	}
+
+	// новый маршрут существующего автобуса: указатель на автобус остается прежним
+	void TransportCatalogue::SetBusStops(std::string_view bus, const std::vector<std::string_view>& stops, const bool is_roundtrip) {
+		assert(!stops.empty());
+		Bus* ptr_bus = buses_name_to_ptr_.at(bus);
+		RemoveBusFromStops(ptr_bus);
+		ptr_bus->is_roundtrip = is_roundtrip;
+		ptr_bus->bus_stops.clear();
+		for (std::string_view stop_name : stops) {
+			assert(FindStop(stop_name) != nullptr);
+			ptr_bus->bus_stops.push_back(stop_name_to_ptr_.at(stop_name));
+		}
+		AddBusToStops(ptr_bus);
+		CalculationRouteDistances(ptr_bus);
+		++version_;
+	}
+
+	const RouteDistances& TransportCatalogue::GetRouteDistances(const Bus* bus) const {
+		return bus_route_distances_.at(bus);
 	}
 
 	std::size_t TransportCatalogue::GetCountStopsBus(std::string_view bus) const {
@@ -90,6 +118,7 @@ namespace transportcatalogue {
 	}
 
 	void TransportCatalogue::SetDistanceBetweenStops(const std::string_view stop_a, const std::string_view stop_b, const int distance) {
+		++version_;
 		assert(FindStop(stop_a) != nullptr);
 		assert(FindStop(stop_b) != nullptr);
 		distance_between_stops_[PairStops(FindStop(stop_a), FindStop(stop_b))] = distance;
@@ -102,9 +131,20 @@ namespace transportcatalogue {
 		if (distance_between_stops_.find(PairStops(FindStop(stop_b), FindStop(stop_b))) == distance_between_stops_.end()) {
 			distance_between_stops_[PairStops(FindStop(stop_b), FindStop(stop_b))] = 0;
 		}
+		// обычно расстояния задаются до автобусов; иначе пересчитываются суммы только тех автобусов,
+		// которые проходят через stop_a или stop_b: другие расстояния не изменились
+		for (const Stop* ptr_stop : { FindStop(stop_a), FindStop(stop_b) }) {
+			const auto it_buses = stop_to_buses_.find(ptr_stop);
+			if (it_buses == stop_to_buses_.end()) {
+				continue;
+			}
+			for (const Bus* ptr_bus : it_buses->second) {
+				CalculationRouteDistances(ptr_bus);
+			}
+		}
 	}
 
-	int TransportCatalogue::GetDistanceBetweenStops(const std::string_view stop_a, const std::string_view stop_b) {
+	int TransportCatalogue::GetDistanceBetweenStops(const std::string_view stop_a, const std::string_view stop_b) const {
 		assert(FindStop(stop_a) != nullptr);
 		assert(FindStop(stop_b) != nullptr);
 		return distance_between_stops_.find(PairStops(FindStop(stop_a), FindStop(stop_b))) == distance_between_stops_.end() ? 0
@@ -136,26 +176,50 @@ namespace transportcatalogue {
 	}
 
 	int TransportCatalogue::CalculationRouteLengthInMeters(std::string_view bus) const {
-		Stop* first_stop = buses_name_to_ptr_.at(bus)->bus_stops.at(0);
-		Stop* second_stop = nullptr;
-		
-		int distance = buses_name_to_ptr_.at(bus)->is_roundtrip ? 0:
-			distance_between_stops_.at(PairStops(first_stop, first_stop));
-		
-		for (size_t i = 1; i < buses_name_to_ptr_.at(bus)->bus_stops.size(); ++i) {
-			second_stop = buses_name_to_ptr_.at(bus)->bus_stops.at(i);
-			distance += distance_between_stops_.at(PairStops(first_stop, second_stop));
-			first_stop = second_stop;
-		}
-		
-		if (!buses_name_to_ptr_.at(bus)->is_roundtrip) {
-			distance += distance_between_stops_.at(PairStops(second_stop, second_stop));
-			for (auto i = buses_name_to_ptr_.at(bus)->bus_stops.size() - 1; i-- > 0 ;) {
-				second_stop = buses_name_to_ptr_.at(bus)->bus_stops.at(i);
-				distance += distance_between_stops_.at(PairStops(first_stop, second_stop));
-				first_stop = second_stop;
-			}
+		const Bus* ptr_bus = buses_name_to_ptr_.at(bus);
+		const RouteDistances& route_distances = bus_route_distances_.at(ptr_bus);
+		const size_t last = ptr_bus->bus_stops.size() - 1;
+
+		int distance = route_distances.GetDistance(0, last);
+		if (!ptr_bus->is_roundtrip) {
+			// разворот на конечных остановках
+			distance += FindDistance(ptr_bus->bus_stops.front(), ptr_bus->bus_stops.front());
+			distance += FindDistance(ptr_bus->bus_stops.back(), ptr_bus->bus_stops.back());
+			distance += route_distances.GetDistance(last, 0);
 		}
 		return distance;
 	}
+
+	int TransportCatalogue::FindDistance(Stop* stop_a, Stop* stop_b) const {
+		const auto it = distance_between_stops_.find(PairStops(stop_a, stop_b));
+		return it == distance_between_stops_.end() ? 0 : it->second;
+	}
+
+	// префиксные суммы расстояний, чтобы расстояние любого отрезка маршрута считалось вычитанием
+	void TransportCatalogue::CalculationRouteDistances(const Bus* bus) {
+		RouteDistances& route_distances = bus_route_distances_[bus];
+		route_distances.forward.assign(1, 0);
+		route_distances.backward.assign(1, 0);
+		for (size_t i = 1; i < bus->bus_stops.size(); ++i) {
+			route_distances.forward.push_back(route_distances.forward.back() + FindDistance(bus->bus_stops[i - 1], bus->bus_stops[i]));
+			route_distances.backward.push_back(route_distances.backward.back() + FindDistance(bus->bus_stops[i], bus->bus_stops[i - 1]));
+		}
+	}
+
+	// повторная остановка того же автобуса находит его последним в списке
+	void TransportCatalogue::AddBusToStops(Bus* bus) {
+		for (const Stop* ptr_stop : bus->bus_stops) {
+			std::vector<Bus*>& buses = stop_to_buses_[ptr_stop];
+			if (buses.empty() || buses.back() != bus) {
+				buses.push_back(bus);
+			}
+		}
+	}
+
+	void TransportCatalogue::RemoveBusFromStops(const Bus* bus) {
+		for (const Stop* ptr_stop : bus->bus_stops) {
+			std::vector<Bus*>& buses = stop_to_buses_[ptr_stop];
+			buses.erase(std::remove(buses.begin(), buses.end(), bus), buses.end());
+		}
+	}
 } // end transportcatalogue
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <memory>
 #include <cassert>
+#include <cstdint>
 
 #include "geo.h"
 #include "domain.h"
@@ -33,12 +34,17 @@ namespace transportcatalogue {
 		std::size_t GetCountStops() const;
 
 		void AddBus(const std::string& bus, const std::vector<std::string_view>& stops, const bool is_roundtrip);
+		void SetBusStops(std::string_view bus, const std::vector<std::string_view>& stops, const bool is_roundtrip);
 		BusInfo GetBusInfo(std::string_view bus) const;
 		Bus* FindsBus(std::string_view bus) const;
 		std::vector<Bus*> GetListAllBuses() const;
+		const RouteDistances& GetRouteDistances(const Bus* bus) const;
 
 		void SetDistanceBetweenStops(const std::string_view stop_a, const std::string_view stop_b, int distance);
-		int GetDistanceBetweenStops(const std::string_view stop_a, const std::string_view stop_b);
+		int GetDistanceBetweenStops(const std::string_view stop_a, const std::string_view stop_b) const;
+
+		// Номер версии данных: меняется при каждом добавлении и изменении остановок, автобусов и расстояний
+		uint64_t GetVersion() const;
 
 	private:
 		std::deque<Stop> stops_;
@@ -47,6 +53,9 @@ namespace transportcatalogue {
 
 		std::deque<Bus> buses_;
 		std::unordered_map<std::string_view, Bus*> buses_name_to_ptr_;
+		std::unordered_map<const Bus*, RouteDistances> bus_route_distances_;
+		std::unordered_map<const Stop*, std::vector<Bus*>> stop_to_buses_; // автобусы через остановку, каждый один раз
+		uint64_t version_ = 0;
 
 		std::size_t GetCountStopsBus(std::string_view bus) const;
 		std::size_t GetCountUniqueStopsBus(std::string_view bus) const;
@@ -55,6 +64,10 @@ namespace transportcatalogue {
 		size_t CalculationUniqueStops(std::string_view bus) const;
 		double CalculationRouteLengthGeographical(std::string_view bus) const;
 		int CalculationRouteLengthInMeters(std::string_view bus) const;
+		int FindDistance(Stop* stop_a, Stop* stop_b) const;
+		void CalculationRouteDistances(const Bus* bus);
+		void AddBusToStops(Bus* bus);
+		void RemoveBusFromStops(const Bus* bus);
 	};
 
 } // end transportcatalogue::
@@ -1,38 +1,711 @@
 #include "transport_router.h"
+#include "raptor_router.h"
+#include "routing_file.h"
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
 
 namespace router {
+	bool RoutingSettings::operator==(const RoutingSettings& other) const {
+		return std::tie(bus_wait_time, bus_velocity, router_mode, max_cached_trees, router_threads, alt_landmarks,
+			fixed_point_weights, vertex_order, routing_file, compact_graph, profiles, route_cache_size, router_build)
+			== std::tie(other.bus_wait_time, other.bus_velocity, other.router_mode, other.max_cached_trees, other.router_threads,
+				other.alt_landmarks, other.fixed_point_weights, other.vertex_order, other.routing_file, other.compact_graph,
+				other.profiles, other.route_cache_size, other.router_build);
+	}
+
 	CreateGraphAndRoute::CreateGraphAndRoute(transportcatalogue::TransportCatalogue& catalogue, RoutingSettings routing_settings)
 		:catalogue_(catalogue),
-		routing_settings_(routing_settings),
-		graph_(catalogue.GetCountStops() * 2),  //  
-		all_stops_ptr_(catalogue.GetListPtrAllStops()) {
-		CreateEdgeFromAndToByStops(all_stops_ptr_); //to - , from - 
+		routing_settings_(routing_settings) {
+		Build();
+	}
+
+	//    :    ( ),    
+	//   ,     .     
+	void CreateGraphAndRoute::Update() {
+		//   (RAPTOR,  )       
+		if (routing_settings_.router_mode == RouterMode::RAPTOR || !routing_settings_.routing_file.empty()
+			|| catalogue_.GetCountStops() != all_stops_ptr_.size()) {
+			router_u_ptr_.reset();
+			fixed_router_u_ptr_.reset();
+			raptor_u_ptr_.reset();
+			mapped_routes_u_ptr_.reset();
+			Build();
+			return;
+		}
+		if (routing_settings_.fixed_point_weights) {
+			const graph::DirectedWeightedGraph<FixedTime> old_graph = std::move(fixed_graph_);
+			BuildGraph();
+			fixed_graph_ = MakeFixedGraph();
+			graph_ = {};
+			UpdateRouter(old_graph, fixed_graph_, fixed_csr_graph_, fixed_router_u_ptr_);
+			return;
+		}
+		const graph::DirectedWeightedGraph<double> old_graph = std::move(graph_);
+		BuildGraph();
+		UpdateRouter(old_graph, graph_, csr_graph_, router_u_ptr_);
+	}
+
+	template <typename Weight>
+	void CreateGraphAndRoute::UpdateRouter(const graph::DirectedWeightedGraph<Weight>& old_graph, const graph::DirectedWeightedGraph<Weight>& graph,
+		graph::CsrGraph<Weight>& csr_graph, std::unique_ptr<graph::RouteEngine<Weight>>& router) const {
+		csr_graph = graph::CsrGraph<Weight>(graph);
+		if (graph.GetVertexCount() == old_graph.GetVertexCount() && router->UpdateGraph(graph::MakeGraphDiff(old_graph, graph))) {
+			return;
+		}
+		router.reset();
+		router = MakeRouter(graph, csr_graph);
+	}
+
+	void CreateGraphAndRoute::Build() {
+		all_stops_ptr_ = catalogue_.GetListPtrAllStops();
+		stop_spatial_index_ = transportcatalogue::StopSpatialIndex(all_stops_ptr_);
+		if (routing_settings_.router_mode == RouterMode::RAPTOR) {
+			raptor_u_ptr_ = std::make_unique<RaptorRouter>(catalogue_, routing_settings_);
+			return;
+		}
+		const bool use_routing_file = !routing_settings_.routing_file.empty();
+		const uint64_t fingerprint = use_routing_file ? ComputeFingerprint() : 0;
+		if (use_routing_file) {
+			mapped_routes_u_ptr_ = MappedRoutes::Open(routing_settings_.routing_file, fingerprint, catalogue_);
+		}
+		BuildGraph();
+		if (use_routing_file) {
+			//       ,      
+			csr_graph_ = graph::CsrGraph<double>(graph_);
+			if (mapped_routes_u_ptr_) { return; }
+			//        (  ,   Router),      
+			auto compact_router = std::make_unique<graph::CompactRouter<double>>(csr_graph_, routing_settings_.router_threads);
+			if (SaveRoutingFile(compact_router->GetRouteCells(), fingerprint)) {
+				mapped_routes_u_ptr_ = MappedRoutes::Open(routing_settings_.routing_file, fingerprint, catalogue_);
+			}
+			if (mapped_routes_u_ptr_) { return; }
+			router_u_ptr_ = std::move(compact_router); //     -   
+			return;
+		}
+		if (routing_settings_.fixed_point_weights) {
+			fixed_graph_ = MakeFixedGraph();
+			graph_ = {};
+			fixed_csr_graph_ = graph::CsrGraph<FixedTime>(fixed_graph_);
+			fixed_router_u_ptr_ = MakeRouter(fixed_graph_, fixed_csr_graph_);
+			return;
+		}
+		csr_graph_ = graph::CsrGraph<double>(graph_);
+		router_u_ptr_ = MakeRouter(graph_, csr_graph_);
+	}
+
+	//    :   ,      
+	void CreateGraphAndRoute::BuildGraph() {
+		id_edge_ptr_stop_.clear();
+		id_edge_dop_info_.clear();
+		ptr_stop_id_edge_to_.clear();
+		edge_costs_.clear();
+		id_edge_alternatives_.clear();
+		if (routing_settings_.vertex_order == VertexOrder::HILBERT) {
+			OrderStopsByLocality();
+		}
 		std::vector<Bus*> list_ptr_buses = catalogue_.GetListAllBuses();
-		for (Bus* ptr_bus : list_ptr_buses) {
-			if (ptr_bus->bus_stops.empty() || ptr_bus->bus_stops.size() == 1) { continue; }
-			MakeEdgeBus(ptr_bus);
+		concurrency::ThreadPool thread_pool(routing_settings_.router_threads);
+		if (routing_settings_.compact_graph) {
+			CreateCompactGraph(list_ptr_buses, thread_pool);
+		}
+		else {
+			graph_ = graph::DirectedWeightedGraph<double>(all_stops_ptr_.size() * 2);  //  
+			CreateEdgeFromAndToByStops(all_stops_ptr_); //to - , from - 
+			//           
+			//   ,     ,    
+			std::vector<EdgeBuffer> bus_edges(list_ptr_buses.size());
+			thread_pool.ParallelFor(list_ptr_buses.size(), [&](size_t index) {
+				const Bus* ptr_bus = list_ptr_buses[index];
+				if (ptr_bus->bus_stops.empty() || ptr_bus->bus_stops.size() == 1) { return; }
+				MakeEdgeBus(ptr_bus, bus_edges[index]);
+			});
+			for (const EdgeBuffer& edges : bus_edges) {
+				AddEdges(edges);
+			}
+		}
+		CollapseParallelEdges();
+	}
+
+	graph::DirectedWeightedGraph<FixedTime> CreateGraphAndRoute::MakeFixedGraph() const {
+		graph::DirectedWeightedGraph<FixedTime> fixed_graph(graph_.GetVertexCount());
+		for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+			const auto& edge = graph_.GetEdge(edge_id);
+			fixed_graph.AddEdge({ edge.from, edge.to, TimeTraits<FixedTime>::FromMinutes(edge.weight) });
 		}
-		router_u_ptr_ = std::make_unique<graph::Router<double>>(graph_);
+		return fixed_graph;
 	}
 
+	template <typename Weight>
+	std::unique_ptr<graph::RouteEngine<Weight>> CreateGraphAndRoute::MakeRouter(const graph::DirectedWeightedGraph<Weight>& graph,
+		const graph::CsrGraph<Weight>& csr_graph) const {
+		switch (routing_settings_.router_mode) {
+		case RouterMode::ALL_PAIRS_BLOCKED:
+			return std::make_unique<graph::BlockedRouter<Weight>>(graph, routing_settings_.router_threads);
+		case RouterMode::ALL_PAIRS_COMPACT:
+			return std::make_unique<graph::CompactRouter<Weight>>(csr_graph, routing_settings_.router_threads);
+		case RouterMode::DIJKSTRA:
+			return std::make_unique<graph::DijkstraRouter<Weight>>(csr_graph, routing_settings_.max_cached_trees);
+		case RouterMode::CONTRACTION_HIERARCHY:
+			return std::make_unique<graph::ContractionHierarchy<Weight>>(csr_graph);
+		case RouterMode::ALT:
+			//           FixedTime  
+			//    ,        
+			if constexpr (std::is_same_v<Weight, double>) {
+				return std::make_unique<graph::AltRouter<Weight>>(csr_graph, routing_settings_.alt_landmarks,
+					[this, geo_factor = ComputeGeoFactor()](graph::VertexId from, graph::VertexId to) {
+						return ComputeLowerBound(from, to, geo_factor);
+					});
+			}
+			else {
+				return std::make_unique<graph::AltRouter<Weight>>(csr_graph, routing_settings_.alt_landmarks);
+			}
+		case RouterMode::ALL_PAIRS:
+		default:
+			return std::make_unique<graph::Router<Weight>>(graph);
+		}
+	}
+
+	//          (  1).
+	//      ,    
+	//      ,    
+	double CreateGraphAndRoute::ComputeGeoFactor() const {
+		double geo_factor = 1.0;
+		for (const Bus* ptr_bus : catalogue_.GetListAllBuses()) {
+			const RouteDistances& route_distances = catalogue_.GetRouteDistances(ptr_bus);
+			for (size_t i = 1; i < ptr_bus->bus_stops.size(); ++i) {
+				const Stop* stop_a = ptr_bus->bus_stops[i - 1];
+				const Stop* stop_b = ptr_bus->bus_stops[i];
+				const double geo_distance = detail::ComputeDistance(stop_a->coordinates, stop_b->coordinates);
+				if (geo_distance <= 0) {
+					continue;
+				}
+				geo_factor = std::min(geo_factor, route_distances.GetDistance(i - 1, i) / geo_distance);
+				if (!ptr_bus->is_roundtrip) {
+					geo_factor = std::min(geo_factor, route_distances.GetDistance(i, i - 1) / geo_distance);
+				}
+			}
+		}
+		return std::max(geo_factor, 0.0);
+	}
+
+	//        :     
+	//    ()   ,     ()
+	//     .       
+	//   ,        
+	double CreateGraphAndRoute::ComputeLowerBound(graph::VertexId from, graph::VertexId to, double geo_factor) const {
+		const Stop* stop_from = id_edge_ptr_stop_.at(from);
+		const Stop* stop_to = id_edge_ptr_stop_.at(to);
+		const bool need_wait_from = routing_settings_.compact_graph ? from < all_stops_ptr_.size() : from % 2 == 0;
+		const bool need_wait_to = !routing_settings_.compact_graph && to % 2 == 1;
+		if (stop_from == stop_to) {
+			return need_wait_from && need_wait_to ? routing_settings_.bus_wait_time * 1.0 : 0.0;
+		}
+		double bound = geo_factor * detail::ComputeDistance(stop_from->coordinates, stop_to->coordinates)
+			/ (routing_settings_.bus_velocity * 1000.0 / 60);
+		if (need_wait_from) {
+			bound += routing_settings_.bus_wait_time;
+		}
+		if (need_wait_to) {
+			bound += routing_settings_.bus_wait_time;
+		}
+		return bound;
+	}
+
+	CreateGraphAndRoute::~CreateGraphAndRoute() = default;
+
 	std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>> CreateGraphAndRoute::BuildRoute(const Stop* from, const Stop* to) const {
-		auto route_info = router_u_ptr_->BuildRoute(ptr_stop_id_edge_to_.at(catalogue_.FindStop(from->stop_name)), 
-													ptr_stop_id_edge_to_.at(catalogue_.FindStop(to->stop_name)));
+		RouteItemCollector collector;
+		const std::optional<double> total_time = VisitRoute(from, to, collector);
+		if (!total_time) {
+			return {};
+		}
+		return std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>> {std::pair{ std::move(collector.items), *total_time }};
+	}
+
+	std::optional<double> CreateGraphAndRoute::VisitRoute(const Stop* from, const Stop* to, RouteItemVisitor& visitor) const {
+		if (raptor_u_ptr_) {
+			//  RAPTOR      ,     
+			const auto route = raptor_u_ptr_->BuildRoute(from, to, {}, routing_settings_.GetDefaultProfile());
+			if (!route) {
+				return std::nullopt;
+			}
+			for (const IdEgeInfoForPrint& item : route->first) {
+				visitor.VisitItem(item);
+			}
+			return route->second;
+		}
+		if (mapped_routes_u_ptr_) {
+			return mapped_routes_u_ptr_->VisitRoute(from, to, visitor);
+		}
+		if (fixed_router_u_ptr_) {
+			return VisitRouteByEngine(*fixed_router_u_ptr_, from, to, visitor);
+		}
+		return VisitRouteByEngine(*router_u_ptr_, from, to, visitor);
+	}
+
+	std::optional<double> CreateGraphAndRoute::VisitRoute(const Stop* from, const Stop* to, const RouteClosures& closures,
+		const RoutingProfile* profile, RouteItemVisitor& visitor) const {
+		if (closures.IsEmpty() && profile == nullptr) {
+			return VisitRoute(from, to, visitor);
+		}
+		const auto route = BuildRoute(from, to, closures, profile);
+		if (!route) {
+			return std::nullopt;
+		}
+		for (const IdEgeInfoForPrint& item : route->first) {
+			visitor.VisitItem(item);
+		}
+		return route->second;
+	}
+
+	std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>> CreateGraphAndRoute::BuildRoute(const Stop* from, const Stop* to,
+		const RouteClosures& closures, const RoutingProfile* profile) const {
+		if (closures.IsEmpty() && profile == nullptr) {
+			return BuildRoute(from, to);
+		}
+		if (raptor_u_ptr_) {
+			return raptor_u_ptr_->BuildRoute(from, to, closures, profile ? *profile : routing_settings_.GetDefaultProfile());
+		}
+		if (fixed_router_u_ptr_) {
+			return std::move(BuildRoutesWithOptions(fixed_csr_graph_, from, { to }, closures, profile).front());
+		}
+		return std::move(BuildRoutesWithOptions(csr_graph_, from, { to }, closures, profile).front());
+	}
+
+	std::vector<std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>>> CreateGraphAndRoute::BuildRoutes(const Stop* from,
+		const std::vector<const Stop*>& to, const RoutingProfile* profile) const {
+		if (raptor_u_ptr_) {
+			return raptor_u_ptr_->BuildRoutes(from, to, {}, profile ? *profile : routing_settings_.GetDefaultProfile());
+		}
+		if (profile != nullptr) {
+			if (fixed_router_u_ptr_) {
+				return BuildRoutesWithOptions(fixed_csr_graph_, from, to, {}, profile);
+			}
+			return BuildRoutesWithOptions(csr_graph_, from, to, {}, profile);
+		}
+		if (mapped_routes_u_ptr_) {
+			std::vector<std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>>> routes;
+			routes.reserve(to.size());
+			for (const Stop* ptr_stop_to : to) {
+				routes.push_back(mapped_routes_u_ptr_->BuildRoute(from, ptr_stop_to));
+			}
+			return routes;
+		}
+		if (fixed_router_u_ptr_) {
+			return BuildRoutesByEngine(*fixed_router_u_ptr_, from, to);
+		}
+		return BuildRoutesByEngine(*router_u_ptr_, from, to);
+	}
+
+	//      ,    ,  
+	//  visitor  :  ,         
+	template <typename Weight>
+	std::optional<double> CreateGraphAndRoute::VisitRouteByEngine(const graph::RouteEngine<Weight>& engine, const Stop* from,
+		const Stop* to, RouteItemVisitor& visitor) const {
+		thread_local std::vector<graph::EdgeId> edges;
+		const std::optional<Weight> weight = engine.BuildRouteEdges(ptr_stop_id_edge_to_.at(from), ptr_stop_id_edge_to_.at(to), edges);
+		if (!weight) {
+			return std::nullopt;
+		}
+		RouteItemCollapser collapser(visitor);
+		for (const graph::EdgeId edge_id : edges) {
+			const auto it_info = id_edge_dop_info_.find(edge_id);
+			if (it_info == id_edge_dop_info_.end()) { continue; } //      
+			collapser.Add(it_info->second);
+		}
+		const double items_time = collapser.Finish();
+		//   MakeRouteAnswer:        
+		return TimeTraits<Weight>::IS_EXACT ? TimeTraits<Weight>::ToMinutes(*weight) : items_time;
+	}
+
+	template <typename Weight>
+	std::vector<std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>>> CreateGraphAndRoute::BuildRoutesByEngine(
+		const graph::RouteEngine<Weight>& engine, const Stop* from, const std::vector<const Stop*>& to) const {
+		std::vector<graph::VertexId> targets;
+		targets.reserve(to.size());
+		for (const Stop* ptr_stop_to : to) {
+			targets.push_back(ptr_stop_id_edge_to_.at(ptr_stop_to));
+		}
+		const auto routes_info = engine.BuildRoutes(ptr_stop_id_edge_to_.at(from), targets);
+		std::vector<std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>>> routes;
+		routes.reserve(routes_info.size());
+		for (const auto& route_info : routes_info) {
+			routes.push_back(MakeRouteAnswer<Weight>(route_info, {}, nullptr));
+		}
+		return routes;
+	}
+
+	//       :    ,  
+	//         ( id_edge_alternatives_,
+	//    replaced_trips)  
+	template <typename Weight>
+	graph::EdgeOverlay<Weight> CreateGraphAndRoute::MakeOverlay(const graph::CsrGraph<Weight>& graph, const RouteClosures& closures,
+		const RoutingProfile* profile, std::unordered_map<graph::EdgeId, AlternativeTrip>& replaced_trips) const {
+		graph::EdgeOverlay<Weight> overlay(graph.GetEdgeCount());
+		if (closures.IsEmpty()) {
+			return overlay;
+		}
+		std::vector<bool> closed_vertices(graph.GetVertexCount(), false);
+		for (Stop* ptr_stop : closures.stops) {
+			const auto it_vertex = ptr_stop_id_edge_to_.find(ptr_stop);
+			if (it_vertex == ptr_stop_id_edge_to_.end()) { continue; }
+			closed_vertices[it_vertex->second] = true;
+			if (!routing_settings_.compact_graph) {
+				closed_vertices[it_vertex->second + 1] = true;
+			}
+		}
+
+		for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+			const auto& edge = graph.GetEdge(edge_id);
+			if (closed_vertices[edge.from] || closed_vertices[edge.to]) {
+				overlay.Block(edge_id);
+				continue;
+			}
+			const auto it_info = id_edge_dop_info_.find(edge_id);
+			if (it_info == id_edge_dop_info_.end() || !it_info->second.IsBus() || closures.buses.count(it_info->second.ptr_bus_route) == 0) {
+				continue;
+			}
+			const AlternativeTrip* replacement = nullptr;
+			if (const auto it_alternatives = id_edge_alternatives_.find(edge_id); it_alternatives != id_edge_alternatives_.end()) {
+				for (const AlternativeTrip& alternative : it_alternatives->second) {
+					if (closures.buses.count(alternative.info.ptr_bus_route) == 0 && (!replacement || alternative.info.weight < replacement->info.weight)) {
+						replacement = &alternative;
+					}
+				}
+			}
+			if (replacement == nullptr) {
+				overlay.Block(edge_id);
+				continue;
+			}
+			overlay.SetWeight(edge_id, TimeTraits<Weight>::FromMinutes(profile ? profile->GetTime(replacement->cost) : replacement->info.weight));
+			replaced_trips[edge_id] = *replacement;
+		}
+		return overlay;
+	}
+
+	//          edge_costs_.     
+	//   to,       
+	template <typename Weight>
+	std::vector<std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>>> CreateGraphAndRoute::BuildRoutesWithOptions(
+		const graph::CsrGraph<Weight>& graph, const Stop* from, const std::vector<const Stop*>& to,
+		const RouteClosures& closures, const RoutingProfile* profile) const {
+		std::unordered_map<graph::EdgeId, AlternativeTrip> replaced_trips;
+		const graph::EdgeOverlay<Weight> overlay = MakeOverlay(graph, closures, profile, replaced_trips);
+
+		const graph::VertexId vertex_from = ptr_stop_id_edge_to_.at(from);
+		std::vector<graph::VertexId> targets;
+		targets.reserve(to.size());
+		for (const Stop* ptr_stop_to : to) {
+			targets.push_back(ptr_stop_id_edge_to_.at(ptr_stop_to));
+		}
+		const auto routes_info = profile == nullptr
+			? graph::BuildRoutesWithOverlay(graph, overlay, vertex_from, targets)
+			: graph::BuildRoutesWithOverlay(graph, overlay, vertex_from, targets, [this, profile](const auto& edge) {
+				return TimeTraits<Weight>::FromMinutes(profile->GetTime(edge_costs_[edge.id]));
+			});
+		std::vector<std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>>> routes;
+		routes.reserve(routes_info.size());
+		for (const auto& route_info : routes_info) {
+			routes.push_back(MakeRouteAnswer<Weight>(route_info, replaced_trips, profile));
+		}
+		return routes;
+	}
+
+	std::optional<SetRoute> CreateGraphAndRoute::BuildRouteBetweenSets(const std::vector<RouteEndpoint>& from,
+		const std::vector<RouteEndpoint>& to, const RouteClosures& closures, const RoutingProfile* profile) const {
+		if (from.empty() || to.empty()) {
+			return std::nullopt;
+		}
+		if (raptor_u_ptr_) {
+			return raptor_u_ptr_->BuildRouteBetweenSets(from, to, closures, profile ? *profile : routing_settings_.GetDefaultProfile());
+		}
+		if (fixed_router_u_ptr_) {
+			return BuildRouteBetweenSetsInGraph(fixed_csr_graph_, from, to, closures, profile);
+		}
+		return BuildRouteBetweenSetsInGraph(csr_graph_, from, to, closures, profile);
+	}
+
+	//   -        ,   
+	template <typename Weight>
+	std::optional<SetRoute> CreateGraphAndRoute::BuildRouteBetweenSetsInGraph(const graph::CsrGraph<Weight>& graph,
+		const std::vector<RouteEndpoint>& from, const std::vector<RouteEndpoint>& to, const RouteClosures& closures,
+		const RoutingProfile* profile) const {
+		std::unordered_map<graph::EdgeId, AlternativeTrip> replaced_trips;
+		const graph::EdgeOverlay<Weight> overlay = MakeOverlay(graph, closures, profile, replaced_trips);
+		const auto make_vertices = [this](const std::vector<RouteEndpoint>& endpoints) {
+			std::vector<std::pair<graph::VertexId, Weight>> vertices;
+			vertices.reserve(endpoints.size());
+			for (const RouteEndpoint& endpoint : endpoints) {
+				vertices.push_back({ ptr_stop_id_edge_to_.at(endpoint.stop),
+					TimeTraits<Weight>::FromMinutes(endpoint.time) });
+			}
+			return vertices;
+		};
+		const auto set_route = profile == nullptr
+			? graph::BuildRouteBetweenSetsWithOverlay(graph, overlay, make_vertices(from), make_vertices(to), [](const auto& edge) {
+				return edge.weight;
+			})
+			: graph::BuildRouteBetweenSetsWithOverlay(graph, overlay, make_vertices(from), make_vertices(to), [this, profile](const auto& edge) {
+				return TimeTraits<Weight>::FromMinutes(profile->GetTime(edge_costs_[edge.id]));
+			});
+		if (!set_route) {
+			return std::nullopt;
+		}
+		auto route_answer = MakeRouteAnswer<Weight>(set_route->route, replaced_trips, profile);
+		return SetRoute{ set_route->source_index, set_route->target_index, std::move(route_answer->first),
+			from[set_route->source_index].time + route_answer->second + to[set_route->target_index].time };
+	}
+
+	std::vector<std::pair<Stop*, double>> CreateGraphAndRoute::FindStopsNear(detail::Coordinates point, double radius) const {
+		return stop_spatial_index_.FindStopsWithin(point, radius);
+	}
+
+	std::vector<std::pair<Stop*, double>> CreateGraphAndRoute::FindReachableStops(const Stop* from, double max_time,
+		const RouteClosures& closures, const RoutingProfile* profile) const {
+		std::vector<std::pair<Stop*, double>> reachable_stops;
+		if (raptor_u_ptr_) {
+			reachable_stops = raptor_u_ptr_->FindReachableStops(from, max_time, closures, profile ? *profile : routing_settings_.GetDefaultProfile());
+		}
+		else if (fixed_router_u_ptr_) {
+			reachable_stops = FindReachableStopsInGraph(fixed_csr_graph_, from, max_time, closures, profile);
+		}
+		else {
+			reachable_stops = FindReachableStopsInGraph(csr_graph_, from, max_time, closures, profile);
+		}
+		std::sort(reachable_stops.begin(), reachable_stops.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.second < rhs.second || (lhs.second == rhs.second && lhs.first->stop_name < rhs.first->stop_name);
+		});
+		return reachable_stops;
+	}
+
+	//     -       (   -   )
+	template <typename Weight>
+	std::vector<std::pair<Stop*, double>> CreateGraphAndRoute::FindReachableStopsInGraph(const graph::CsrGraph<Weight>& graph,
+		const Stop* from, double max_time, const RouteClosures& closures, const RoutingProfile* profile) const {
+		std::unordered_map<graph::EdgeId, AlternativeTrip> replaced_trips;
+		const graph::EdgeOverlay<Weight> overlay = MakeOverlay(graph, closures, profile, replaced_trips);
+		const graph::VertexId vertex_from = ptr_stop_id_edge_to_.at(from);
+		const Weight max_weight = TimeTraits<Weight>::FromMinutes(max_time);
+		const auto reachable = profile == nullptr
+			? graph::FindReachableWithOverlay(graph, overlay, vertex_from, max_weight, [](const auto& edge) {
+				return edge.weight;
+			})
+			: graph::FindReachableWithOverlay(graph, overlay, vertex_from, max_weight, [this, profile](const auto& edge) {
+				return TimeTraits<Weight>::FromMinutes(profile->GetTime(edge_costs_[edge.id]));
+			});
+
+		//   MakeRouteAnswer,        
+		std::vector<double> vertex_times(TimeTraits<Weight>::IS_EXACT ? 0 : graph.GetVertexCount(), 0.0);
+		std::vector<std::pair<Stop*, double>> reachable_stops;
+		for (const auto& [vertex, weight, prev_edge] : reachable) {
+			double time = TimeTraits<Weight>::ToMinutes(weight);
+			if constexpr (!TimeTraits<Weight>::IS_EXACT) {
+				time = prev_edge == graph::ReachableVertex<Weight>::NO_EDGE ? 0.0
+					: vertex_times[graph.GetEdge(prev_edge).from] + GetEdgeTime(prev_edge, replaced_trips, profile);
+				vertex_times[vertex] = time;
+			}
+			Stop* ptr_stop = id_edge_ptr_stop_.at(vertex);
+			if (ptr_stop_id_edge_to_.at(ptr_stop) == vertex && time <= max_time) {
+				reachable_stops.push_back({ ptr_stop, time });
+			}
+		}
+		return reachable_stops;
+	}
+
+	//      ;       (  ) - 0
+	double CreateGraphAndRoute::GetEdgeTime(graph::EdgeId edge_id, const std::unordered_map<graph::EdgeId, AlternativeTrip>& replaced_trips,
+		const RoutingProfile* profile) const {
+		if (const auto it_replaced = replaced_trips.find(edge_id); it_replaced != replaced_trips.end()) {
+			return profile ? profile->GetTime(it_replaced->second.cost) : it_replaced->second.info.weight;
+		}
+		const auto it_info = id_edge_dop_info_.find(edge_id);
+		if (it_info == id_edge_dop_info_.end()) {
+			return 0.0;
+		}
+		return profile ? profile->GetTime(edge_costs_[edge_id]) : it_info->second.weight;
+	}
+
+	//         
+	template <typename Weight>
+	std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>> CreateGraphAndRoute::MakeRouteAnswer(
+		const std::optional<typename graph::RouteEngine<Weight>::RouteInfo>& route_info,
+		const std::unordered_map<graph::EdgeId, AlternativeTrip>& replaced_trips, const RoutingProfile* profile) const {
 		if (!route_info.has_value()) { 
 			return {};
 		}
 		std::vector<IdEgeInfoForPrint> vector_info_edges;
 		for (graph::EdgeId edges_info : route_info.value().edges) {
-			vector_info_edges.push_back(GetEdgeInfoForPrint(edges_info));
+			IdEgeInfoForPrint info;
+			EdgeCost cost;
+			if (const auto it_replaced = replaced_trips.find(edges_info); it_replaced != replaced_trips.end()) {
+				info = it_replaced->second.info;
+				cost = it_replaced->second.cost;
+			}
+			else {
+				const auto it_info = id_edge_dop_info_.find(edges_info);
+				if (it_info == id_edge_dop_info_.end()) { continue; } //      
+				info = it_info->second;
+				cost = edge_costs_[edges_info];
+			}
+			if (profile != nullptr) {
+				info.weight = profile->GetTime(cost);
+			}
+			AppendRouteItem(vector_info_edges, info);
+		}
+		double total_time = TimeTraits<Weight>::ToMinutes(route_info.value().weight);
+		if constexpr (!TimeTraits<Weight>::IS_EXACT) {
+			//      :     
+			total_time = 0;
+			for (const IdEgeInfoForPrint& info : vector_info_edges) {
+				total_time += info.weight;
+			}
+		}
+		return std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>> {std::pair{ vector_info_edges, total_time }};
+	}
+
+	//     all_stops_ptr_:      
+	// ,       .      - 
+	void CreateGraphAndRoute::OrderStopsByLocality() {
+		if (all_stops_ptr_.empty()) { return; }
+		detail::Coordinates min = all_stops_ptr_.front()->coordinates;
+		detail::Coordinates max = min;
+		for (const Stop* ptr_stop : all_stops_ptr_) {
+			min = { std::min(min.lat, ptr_stop->coordinates.lat), std::min(min.lng, ptr_stop->coordinates.lng) };
+			max = { std::max(max.lat, ptr_stop->coordinates.lat), std::max(max.lng, ptr_stop->coordinates.lng) };
+		}
+		std::vector<std::pair<uint32_t, Stop*>> keys;
+		keys.reserve(all_stops_ptr_.size());
+		for (Stop* ptr_stop : all_stops_ptr_) {
+			keys.push_back({ detail::ComputeHilbertIndex(ptr_stop->coordinates, min, max), ptr_stop });
+		}
+		std::sort(keys.begin(), keys.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.first != rhs.first ? lhs.first < rhs.first : lhs.second->stop_name < rhs.second->stop_name;
+		});
+		for (size_t i = 0; i < keys.size(); ++i) {
+			all_stops_ptr_[i] = keys[i].second;
+		}
+	}
+
+	//  ,    :       .
+	//  ,    ,  
+	uint64_t CreateGraphAndRoute::ComputeFingerprint() const {
+		uint64_t hash = 14695981039346656037ull; // FNV-1a
+		const auto add_bytes = [&hash](const void* data, size_t size) {
+			for (size_t i = 0; i < size; ++i) {
+				hash = (hash ^ static_cast<const unsigned char*>(data)[i]) * 1099511628211ull;
+			}
+		};
+		const auto add_value = [&add_bytes](auto value) {
+			add_bytes(&value, sizeof(value));
+		};
+		const auto add_string = [&](const std::string& value) {
+			add_value(value.size());
+			add_bytes(value.data(), value.size());
+		};
+
+		add_value(routing_settings_.bus_wait_time);
+		add_value(routing_settings_.bus_velocity);
+		add_value(routing_settings_.vertex_order);
+		add_value(routing_settings_.compact_graph);
+		std::vector<Stop*> stops = all_stops_ptr_;
+		std::sort(stops.begin(), stops.end(), [](const Stop* lhs, const Stop* rhs) { return lhs->stop_name < rhs->stop_name; });
+		add_value(stops.size());
+		for (const Stop* ptr_stop : stops) {
+			add_string(ptr_stop->stop_name);
+			add_value(ptr_stop->coordinates.lat);
+			add_value(ptr_stop->coordinates.lng);
+		}
+		const std::vector<Bus*> buses = catalogue_.GetListAllBuses();
+		add_value(buses.size());
+		for (const Bus* ptr_bus : buses) {
+			add_string(ptr_bus->bus_name);
+			add_value(ptr_bus->is_roundtrip);
+			add_value(ptr_bus->bus_stops.size());
+			for (const Stop* ptr_stop : ptr_bus->bus_stops) {
+				add_string(ptr_stop->stop_name);
+			}
+			const RouteDistances& route_distances = catalogue_.GetRouteDistances(ptr_bus);
+			add_bytes(route_distances.forward.data(), route_distances.forward.size() * sizeof(int));
+			add_bytes(route_distances.backward.data(), route_distances.backward.size() * sizeof(int));
+		}
+		return hash;
+	}
+
+	bool CreateGraphAndRoute::SaveRoutingFile(const std::vector<graph::CompactRouteCell>& routes, uint64_t fingerprint) const {
+		using namespace routing_file;
+
+		std::vector<Stop*> stops = all_stops_ptr_;
+		std::sort(stops.begin(), stops.end(), [](const Stop* lhs, const Stop* rhs) { return lhs->stop_name < rhs->stop_name; });
+		std::unordered_map<const Stop*, uint32_t> stop_index;
+		const std::vector<Bus*> buses = catalogue_.GetListAllBuses();
+		std::unordered_map<const Bus*, uint32_t> bus_index;
+		for (uint32_t i = 0; i < buses.size(); ++i) {
+			bus_index[buses[i]] = i;
+		}
+
+		Contents contents;
+		contents.fingerprint = fingerprint;
+		contents.bus_count = buses.size();
+		contents.vertex_count = graph_.GetVertexCount();
+		contents.routes = &routes;
+		for (uint32_t i = 0; i < stops.size(); ++i) {
+			stop_index[stops[i]] = i;
+			contents.stop_vertices.push_back(static_cast<uint32_t>(ptr_stop_id_edge_to_.at(stops[i])));
+		}
+		for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+			const auto& edge = graph_.GetEdge(edge_id);
+			contents.edges.push_back({ static_cast<uint32_t>(edge.from), static_cast<uint32_t>(edge.to), edge.weight });
+			EdgeInfo info{ NO_INDEX, NO_INDEX, 0, 0, 0.0 };
+			if (const auto it_info = id_edge_dop_info_.find(edge_id); it_info != id_edge_dop_info_.end()) {
+				const IdEgeInfoForPrint& print_info = it_info->second;
+				info.bus = print_info.IsBus() ? bus_index.at(print_info.ptr_bus_route) : NO_INDEX;
+				info.stop = print_info.ptr_stop != nullptr ? stop_index.at(print_info.ptr_stop) : NO_INDEX;
+				info.span = static_cast<uint32_t>(print_info.span);
+				info.weight = print_info.weight;
+			}
+			contents.edge_infos.push_back(info);
+		}
+		return Save(routing_settings_.routing_file, contents);
+	}
+
+	void AppendRouteItem(std::vector<IdEgeInfoForPrint>& items, const IdEgeInfoForPrint& item) {
+		if (item.IsBus() && !items.empty() && items.back().ptr_bus_route == item.ptr_bus_route) {
+			items.back().span += item.span;
+			items.back().weight += item.weight;
+			return;
 		}
-		return std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>> {std::pair{ vector_info_edges, route_info.value().weight }};
+		items.push_back(item);
+	}
+
+	void RouteItemCollapser::Add(const IdEgeInfoForPrint& item) {
+		if (item.IsBus() && pending_ && pending_->ptr_bus_route == item.ptr_bus_route) {
+			pending_->span += item.span;
+			pending_->weight += item.weight;
+			return;
+		}
+		if (pending_) {
+			total_time_ += pending_->weight;
+			visitor_.VisitItem(*pending_);
+		}
+		pending_ = item;
+	}
+
+	double RouteItemCollapser::Finish() {
+		if (pending_) {
+			total_time_ += pending_->weight;
+			visitor_.VisitItem(*pending_);
+			pending_.reset();
+		}
+		return total_time_;
 	}
 
 	IdEgeInfoForPrint CreateGraphAndRoute::GetEdgeInfoForPrint(const graph::EdgeId id) const {
 		return id_edge_dop_info_.at(id);
 	}
 
-	double CreateGraphAndRoute::CalculateWeight(const int distance) {
+	double CreateGraphAndRoute::CalculateWeight(const int distance) const {
 		return distance * 1.0 / (routing_settings_.bus_velocity * 1000.0 / 60);
 	}
 
@@ -44,51 +717,191 @@ namespace router {
 			id_edge_dop_info_[id] = { nullptr, ptr_stop, 0, routing_settings_.bus_wait_time * 1.0 };
 			id_edge_ptr_stop_[id] = ptr_stop;
 			graph_.AddEdge({ id, ++id, routing_settings_.bus_wait_time * 1.0 });
+			edge_costs_.push_back({ 0, 1 });
 
 			id_edge_dop_info_[id].ptr_stop = ptr_stop;
 			id_edge_ptr_stop_[id] = ptr_stop;
 			graph_.AddEdge({ id, id, 0.0 });
+			edge_costs_.push_back({});
 			++id;
 		}
 	}
 
-	void CreateGraphAndRoute::MakeEdgeBus(const Bus* ptr_bus) {
+	void CreateGraphAndRoute::AddEdges(const EdgeBuffer& edges) {
+		for (const PendingEdge& pending_edge : edges) {
+			const graph::EdgeId edge_id = graph_.AddEdge(pending_edge.edge);
+			edge_costs_.push_back(pending_edge.cost);
+			if (pending_edge.info) {
+				id_edge_dop_info_[edge_id] = *pending_edge.info;
+			}
+		}
+	}
+
+	void CreateGraphAndRoute::MakeEdgeBus(const Bus* ptr_bus, EdgeBuffer& edges) const {
+		const RouteDistances& route_distances = catalogue_.GetRouteDistances(ptr_bus);
+		const auto distance_to = [&](auto it_from, auto it_to) {
+			return route_distances.GetDistance(it_from - ptr_bus->bus_stops.begin(), it_to - ptr_bus->bus_stops.begin());
+		};
 
 		for (auto it_curent_stop = ptr_bus->bus_stops.begin(); it_curent_stop < ptr_bus->bus_stops.end(); ++it_curent_stop) {
 			if (it_curent_stop != ptr_bus->bus_stops.end()) {
-				auto it_first_stop = it_curent_stop;
 				auto it_second_stop = it_curent_stop + 1;
-				int distance = 0;
 				int span = 0;
 				while (it_second_stop < ptr_bus->bus_stops.end()) {
-					distance += catalogue_.GetDistanceBetweenStops((*it_first_stop)->stop_name, (*it_second_stop)->stop_name);
-					graph_.AddEdge({ ptr_stop_id_edge_to_[*it_curent_stop] + 1, ptr_stop_id_edge_to_[*it_second_stop]
-						, CalculateWeight(distance) });
-					id_edge_dop_info_[graph_.GetEdgeCount() - 1] = { ptr_bus, nullptr, ++span, CalculateWeight(distance) };
-					++it_first_stop;
+					const int distance = distance_to(it_curent_stop, it_second_stop);
+					edges.push_back({ { ptr_stop_id_edge_to_.at(*it_curent_stop) + 1, ptr_stop_id_edge_to_.at(*it_second_stop), CalculateWeight(distance) },
+						IdEgeInfoForPrint{ ptr_bus, nullptr, ++span, CalculateWeight(distance) }, EdgeCost{ distance, 0 } });
 					++it_second_stop;
 				}
 			}
 			if (!ptr_bus->is_roundtrip) {
 				if (it_curent_stop == ptr_bus->bus_stops.begin()) { continue; }
-				auto it_first_stop = it_curent_stop;
 				auto it_second_stop = it_curent_stop - 1;
-				int distance = 0;
 				int span = 0;
 				while (it_second_stop > ptr_bus->bus_stops.begin()) {
-					distance += catalogue_.GetDistanceBetweenStops((*it_first_stop)->stop_name, (*it_second_stop)->stop_name);
-					graph_.AddEdge({ ptr_stop_id_edge_to_[*it_curent_stop] + 1, ptr_stop_id_edge_to_[*it_second_stop]
-						, CalculateWeight(distance) });
-					id_edge_dop_info_[graph_.GetEdgeCount() - 1] = { ptr_bus, nullptr, ++span, CalculateWeight(distance) };
-					--it_first_stop;
+					const int distance = distance_to(it_curent_stop, it_second_stop);
+					edges.push_back({ { ptr_stop_id_edge_to_.at(*it_curent_stop) + 1, ptr_stop_id_edge_to_.at(*it_second_stop), CalculateWeight(distance) },
+						IdEgeInfoForPrint{ ptr_bus, nullptr, ++span, CalculateWeight(distance) }, EdgeCost{ distance, 0 } });
 					--it_second_stop;
 				}
-				distance += catalogue_.GetDistanceBetweenStops((*it_first_stop)->stop_name, (*it_second_stop)->stop_name);
-				graph_.AddEdge({ ptr_stop_id_edge_to_[*it_curent_stop] + 1, ptr_stop_id_edge_to_[*it_second_stop]
-					, CalculateWeight(distance) });
-				id_edge_dop_info_[graph_.GetEdgeCount() - 1] = { ptr_bus, nullptr, ++span, CalculateWeight(distance) };
+				const int distance = distance_to(it_curent_stop, it_second_stop);
+				edges.push_back({ { ptr_stop_id_edge_to_.at(*it_curent_stop) + 1, ptr_stop_id_edge_to_.at(*it_second_stop), CalculateWeight(distance) },
+					IdEgeInfoForPrint{ ptr_bus, nullptr, ++span, CalculateWeight(distance) }, EdgeCost{ distance, 0 } });
 			}
 		}
 	}
 	
+	//  :     ( )     
+	//    .  -   ->    ,
+	//  -     ,  -   ->    .
+	//       
+	void CreateGraphAndRoute::CreateCompactGraph(const std::vector<Bus*>& list_ptr_buses, concurrency::ThreadPool& thread_pool) {
+		size_t vertex_count = all_stops_ptr_.size();
+		for (const Bus* ptr_bus : list_ptr_buses) {
+			if (ptr_bus->bus_stops.size() < 2) { continue; }
+			vertex_count += ptr_bus->bus_stops.size() * (ptr_bus->is_roundtrip ? 1 : 2);
+		}
+		graph_ = graph::DirectedWeightedGraph<double>(vertex_count);
+
+		graph::VertexId id = 0;
+		for (Stop* ptr_stop : all_stops_ptr_) {
+			ptr_stop_id_edge_to_[ptr_stop] = id;
+			id_edge_ptr_stop_[id] = ptr_stop;
+			++id;
+		}
+		std::vector<graph::VertexId> first_ride_vertex(list_ptr_buses.size());
+		for (size_t index = 0; index < list_ptr_buses.size(); ++index) {
+			const Bus* ptr_bus = list_ptr_buses[index];
+			first_ride_vertex[index] = id;
+			if (ptr_bus->bus_stops.size() < 2) { continue; }
+			for (Stop* ptr_stop : ptr_bus->bus_stops) {
+				id_edge_ptr_stop_[id++] = ptr_stop;
+			}
+			if (!ptr_bus->is_roundtrip) {
+				for (auto it = ptr_bus->bus_stops.rbegin(); it != ptr_bus->bus_stops.rend(); ++it) {
+					id_edge_ptr_stop_[id++] = *it;
+				}
+			}
+		}
+
+		std::vector<EdgeBuffer> bus_edges(list_ptr_buses.size());
+		thread_pool.ParallelFor(list_ptr_buses.size(), [&](size_t index) {
+			const Bus* ptr_bus = list_ptr_buses[index];
+			if (ptr_bus->bus_stops.size() < 2) { return; }
+			MakeRideChain(ptr_bus, true, first_ride_vertex[index], bus_edges[index]);
+			if (!ptr_bus->is_roundtrip) {
+				MakeRideChain(ptr_bus, false, first_ride_vertex[index] + ptr_bus->bus_stops.size(), bus_edges[index]);
+			}
+		});
+		for (const EdgeBuffer& edges : bus_edges) {
+			AddEdges(edges);
+		}
+	}
+
+	void CreateGraphAndRoute::MakeRideChain(const Bus* ptr_bus, bool is_forward, graph::VertexId first_ride_vertex, EdgeBuffer& edges) const {
+		const std::vector<Stop*>& bus_stops = ptr_bus->bus_stops;
+		const RouteDistances& route_distances = catalogue_.GetRouteDistances(ptr_bus);
+		const auto stop_index = [&](size_t position) {
+			return is_forward ? position : bus_stops.size() - 1 - position;
+		};
+		for (size_t i = 0; i < bus_stops.size(); ++i) {
+			Stop* ptr_stop = bus_stops[stop_index(i)];
+			const graph::VertexId stop_vertex = ptr_stop_id_edge_to_.at(ptr_stop);
+			const graph::VertexId ride_vertex = first_ride_vertex + i;
+			if (i > 0) {
+				edges.push_back({ { ride_vertex, stop_vertex, 0.0 }, std::nullopt, EdgeCost{} });
+			}
+			if (i + 1 < bus_stops.size()) {
+				const double wait_time = routing_settings_.bus_wait_time * 1.0;
+				edges.push_back({ { stop_vertex, ride_vertex, wait_time }, IdEgeInfoForPrint{ nullptr, ptr_stop, 0, wait_time }, EdgeCost{ 0, 1 } });
+				const int distance = route_distances.GetDistance(stop_index(i), stop_index(i + 1));
+				const double weight = CalculateWeight(distance);
+				edges.push_back({ { ride_vertex, ride_vertex + 1, weight }, IdEgeInfoForPrint{ ptr_bus, nullptr, 1, weight }, EdgeCost{ distance, 0 } });
+			}
+		}
+	}
+
+	//           ,    -
+	//  :     ,      .
+	//     id_edge_alternatives_.       
+	void CreateGraphAndRoute::CollapseParallelEdges() {
+		constexpr graph::EdgeId NO_EDGE = std::numeric_limits<graph::EdgeId>::max();
+		const size_t vertex_count = graph_.GetVertexCount();
+		const size_t edge_count = graph_.GetEdgeCount();
+
+		//       (  -  )
+		std::vector<graph::EdgeId> chosen_edge(edge_count, NO_EDGE);
+		std::vector<graph::EdgeId> chosen_by_target(vertex_count, NO_EDGE);
+		std::vector<graph::VertexId> touched_targets;
+		size_t collapsed_count = 0;
+		for (graph::VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+			for (graph::EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+				const auto it_info = id_edge_dop_info_.find(edge_id);
+				if (it_info == id_edge_dop_info_.end() || !it_info->second.IsBus()) { continue; }
+				const graph::VertexId to = graph_.GetEdge(edge_id).to;
+				graph::EdgeId& chosen = chosen_by_target[to];
+				if (chosen == NO_EDGE) {
+					touched_targets.push_back(to);
+				}
+				else {
+					++collapsed_count;
+				}
+				if (chosen == NO_EDGE || graph_.GetEdge(edge_id).weight < graph_.GetEdge(chosen).weight) {
+					chosen = edge_id;
+				}
+			}
+			for (graph::EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+				const auto it_info = id_edge_dop_info_.find(edge_id);
+				if (it_info == id_edge_dop_info_.end() || !it_info->second.IsBus()) { continue; }
+				chosen_edge[edge_id] = chosen_by_target[graph_.GetEdge(edge_id).to];
+			}
+			for (graph::VertexId to : touched_targets) {
+				chosen_by_target[to] = NO_EDGE;
+			}
+			touched_targets.clear();
+		}
+		if (collapsed_count == 0) { return; }
+
+		graph::DirectedWeightedGraph<double> collapsed_graph(vertex_count);
+		std::unordered_map<graph::EdgeId, IdEgeInfoForPrint> collapsed_info;
+		std::vector<EdgeCost> collapsed_costs;
+		std::vector<graph::EdgeId> new_edge_id(edge_count, NO_EDGE);
+		for (graph::EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+			if (chosen_edge[edge_id] != NO_EDGE && chosen_edge[edge_id] != edge_id) { continue; }
+			new_edge_id[edge_id] = collapsed_graph.AddEdge(graph_.GetEdge(edge_id));
+			collapsed_costs.push_back(edge_costs_[edge_id]);
+			if (const auto it_info = id_edge_dop_info_.find(edge_id); it_info != id_edge_dop_info_.end()) {
+				collapsed_info[new_edge_id[edge_id]] = it_info->second;
+			}
+		}
+		for (graph::EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+			if (chosen_edge[edge_id] != NO_EDGE && chosen_edge[edge_id] != edge_id) {
+				id_edge_alternatives_[new_edge_id[chosen_edge[edge_id]]].push_back({ id_edge_dop_info_.at(edge_id), edge_costs_[edge_id] });
+			}
+		}
+		graph_ = std::move(collapsed_graph);
+		id_edge_dop_info_ = std::move(collapsed_info);
+		edge_costs_ = std::move(collapsed_costs);
+	}
+
 }// router::
\ No newline at end of file
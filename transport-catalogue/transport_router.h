@@ -2,19 +2,124 @@
 
 #include "transport_catalogue.h"
 #include "graph.h"
+#include "csr_graph.h"
 #include "router.h"
+#include "dijkstra_router.h"
+#include "blocked_router.h"
+#include "compact_router.h"
+#include "contraction_hierarchy.h"
+#include "alt_router.h"
+#include "edge_overlay.h"
+#include "stop_spatial_index.h"
+#include "thread_pool.h"
+#include "weight_traits.h"
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <fstream>
+#include <unordered_set>
 
 using namespace transportcatalogue;
 
 namespace router {
 
+	enum class RouterMode {
+		ALL_PAIRS, //      
+		ALL_PAIRS_BLOCKED, //  ,   
+		ALL_PAIRS_COMPACT, //  ,  ,   
+		DIJKSTRA,  //        
+		CONTRACTION_HIERARCHY, //   ,    
+		ALT, //  A*       
+		RAPTOR //       ,  
+	};
+
+	enum class VertexOrder {
+		CATALOGUE, //     
+		HILBERT //      ,   -  
+	};
+
+	enum class RouterBuild {
+		LAZY, //   ,   
+		EAGER //    
+	};
+
+	using FixedTime = uint32_t; //     
+
+	//      ( time  total_time )  
+	template <typename Weight>
+	struct TimeTraits;
+
+	template <>
+	struct TimeTraits<double> {
+		static constexpr bool IS_EXACT = true;
+
+		static double FromMinutes(double minutes) {
+			return minutes;
+		}
+		static double ToMinutes(double weight) {
+			return weight;
+		}
+	};
+
+	template <>
+	struct TimeTraits<FixedTime> {
+		static constexpr bool IS_EXACT = false; //     
+		static constexpr double UNITS_PER_MINUTE = 60 * 100;
+
+		static FixedTime FromMinutes(double minutes) {
+			return static_cast<FixedTime>(std::llround(minutes * UNITS_PER_MINUTE));
+		}
+		static double ToMinutes(FixedTime weight) {
+			return weight / UNITS_PER_MINUTE;
+		}
+	};
+
+	//       :     
+	struct EdgeCost {
+		int distance = 0; // 
+		int boardings = 0;
+	};
+
+	//   .    - bus_wait_time  bus_velocity  RoutingSettings,
+	//           
+	struct RoutingProfile {
+		int bus_wait_time = 1; // 
+		int bus_velocity = 1;  // /
+
+		double GetRideTime(int distance) const {
+			return distance * 1.0 / (bus_velocity * 1000.0 / 60);
+		}
+		double GetTime(const EdgeCost& cost) const {
+			return cost.boardings * bus_wait_time + GetRideTime(cost.distance);
+		}
+
+		bool operator==(const RoutingProfile& other) const {
+			return bus_wait_time == other.bus_wait_time && bus_velocity == other.bus_velocity;
+		}
+	};
+
 	struct RoutingSettings {
 		int bus_wait_time = 1; // 
 		int bus_velocity = 1;  // /
+		RouterMode router_mode = RouterMode::ALL_PAIRS;
+		size_t max_cached_trees = graph::DijkstraRouter<double>::DEFAULT_MAX_CACHED_TREES; //  RouterMode::DIJKSTRA, 0 -  
+		size_t router_threads = 0; //  , RouterMode::ALL_PAIRS_BLOCKED  ALL_PAIRS_COMPACT; 0 -   
+		size_t alt_landmarks = graph::AltRouter<double>::DEFAULT_LANDMARK_COUNT; //  RouterMode::ALT
+		bool fixed_point_weights = false; //   - FixedTime    double
+		VertexOrder vertex_order = VertexOrder::CATALOGUE;
+		std::string routing_file; //     ,  -  
+		bool compact_graph = false; //            
+		std::unordered_map<std::string, RoutingProfile> profiles; //    
+		size_t route_cache_size = 4096; //   Route  , 0 -  
+		RouterBuild router_build = RouterBuild::LAZY;
+
+		RoutingProfile GetDefaultProfile() const {
+			return { bus_wait_time, bus_velocity };
+		}
+
+		bool operator==(const RoutingSettings& other) const;
 	};
 
 	struct IdEgeInfoForPrint {
@@ -28,30 +133,188 @@ namespace router {
 		}
 	};
 
+	//      (     ,   )  
+	struct RouteClosures {
+		std::unordered_set<Stop*> stops;
+		std::unordered_set<const Bus*> buses;
+
+		bool IsEmpty() const {
+			return stops.empty() && buses.empty();
+		}
+	};
+
+	// -      ,      
+	// (,     ), 
+	struct RouteEndpoint {
+		const Stop* stop = nullptr;
+		double time = 0;
+	};
+
+	//     :       
+	struct SetRoute {
+		size_t from_index = 0;
+		size_t to_index = 0;
+		std::vector<IdEgeInfoForPrint> items;
+		double total_time = 0; //    
+	};
+
+	//     ;        
+	void AppendRouteItem(std::vector<IdEgeInfoForPrint>& items, const IdEgeInfoForPrint& item);
+
+	//     ,   ,   
+	class RouteItemVisitor {
+	public:
+		virtual void VisitItem(const IdEgeInfoForPrint& item) = 0;
+
+	protected:
+		~RouteItemVisitor() = default;
+	};
+
+	//     ,  AppendRouteItem,   visitor  .
+	//    ,    
+	class RouteItemCollapser {
+	public:
+		explicit RouteItemCollapser(RouteItemVisitor& visitor)
+			: visitor_(visitor) {
+		}
+
+		void Add(const IdEgeInfoForPrint& item);
+		//   ;     
+		double Finish();
+
+	private:
+		RouteItemVisitor& visitor_;
+		std::optional<IdEgeInfoForPrint> pending_;
+		double total_time_ = 0;
+	};
+
+	//      ,    
+	class RouteItemCollector : public RouteItemVisitor {
+	public:
+		void VisitItem(const IdEgeInfoForPrint& item) override {
+			items.push_back(item);
+		}
+
+		std::vector<IdEgeInfoForPrint> items;
+	};
+
+	class RaptorRouter;
+	class MappedRoutes;
+
 	class CreateGraphAndRoute {
 	public:
 		CreateGraphAndRoute() = default;
 
 		explicit CreateGraphAndRoute(transportcatalogue::TransportCatalogue& catalogue, RoutingSettings routing_settings);
+		~CreateGraphAndRoute();
 
 		std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>> BuildRoute(const Stop* from, const Stop* to) const;
+		//   : visitor    ,  total_time, nullopt -  .
+		//          ,     dijkstra ( 
+		//   )     
+		std::optional<double> VisitRoute(const Stop* from, const Stop* to, RouteItemVisitor& visitor) const;
+		std::optional<double> VisitRoute(const Stop* from, const Stop* to, const RouteClosures& closures,
+			const RoutingProfile* profile, RouteItemVisitor& visitor) const;
+		//       (nullptr -  )  ,   
+		std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>> BuildRoute(const Stop* from, const Stop* to,
+			const RouteClosures& closures, const RoutingProfile* profile = nullptr) const;
+		//      ,   to:     from
+		//      ,       
+		std::vector<std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>>> BuildRoutes(const Stop* from,
+			const std::vector<const Stop*>& to, const RoutingProfile* profile = nullptr) const;
+		//      from    to:      from
+		std::optional<SetRoute> BuildRouteBetweenSets(const std::vector<RouteEndpoint>& from, const std::vector<RouteEndpoint>& to,
+			const RouteClosures& closures, const RoutingProfile* profile = nullptr) const;
+		//    radius       ,   
+		std::vector<std::pair<Stop*, double>> FindStopsNear(detail::Coordinates point, double radius) const;
+		// ,       max_time ,    ,   .
+		//    from,  max_time
+		std::vector<std::pair<Stop*, double>> FindReachableStops(const Stop* from, double max_time,
+			const RouteClosures& closures, const RoutingProfile* profile = nullptr) const;
+		//           
+		void Update();
 
 
 	private:
 		transportcatalogue::TransportCatalogue& catalogue_;
 		RoutingSettings routing_settings_;
 		graph::DirectedWeightedGraph<double> graph_;
+		graph::CsrGraph<double> csr_graph_; //   graph_    
+		graph::DirectedWeightedGraph<FixedTime> fixed_graph_; //  fixed_point_weights, graph_   
+		graph::CsrGraph<FixedTime> fixed_csr_graph_;
 		std::vector<Stop*> all_stops_ptr_;
+		transportcatalogue::StopSpatialIndex stop_spatial_index_;
 		std::unordered_map<graph::VertexId, Stop*> id_edge_ptr_stop_;
 		std::unordered_map<graph::VertexId, IdEgeInfoForPrint> id_edge_dop_info_;
-		std::unordered_map<Stop*, graph::VertexId> ptr_stop_id_edge_to_;
-		std::unique_ptr<graph::Router<double>> router_u_ptr_;
+		std::unordered_map<const Stop*, graph::VertexId> ptr_stop_id_edge_to_;
+		//  ,    
+		struct AlternativeTrip {
+			IdEgeInfoForPrint info;
+			EdgeCost cost;
+		};
+
+		std::vector<EdgeCost> edge_costs_; //    graph_ ( fixed_graph_)
+		std::unordered_map<graph::EdgeId, std::vector<AlternativeTrip>> id_edge_alternatives_;
+		std::unique_ptr<graph::RouteEngine<double>> router_u_ptr_;
+		std::unique_ptr<graph::RouteEngine<FixedTime>> fixed_router_u_ptr_;
+		std::unique_ptr<RaptorRouter> raptor_u_ptr_;
+		std::unique_ptr<MappedRoutes> mapped_routes_u_ptr_;
+
+		//      ;         
+		struct PendingEdge {
+			graph::Edge<double> edge;
+			std::optional<IdEgeInfoForPrint> info;
+			EdgeCost cost;
+		};
+		using EdgeBuffer = std::vector<PendingEdge>;
 
-		double CalculateWeight(const int distance);
+		void Build();
+		void BuildGraph();
+		graph::DirectedWeightedGraph<FixedTime> MakeFixedGraph() const;
+		double CalculateWeight(const int distance) const;
+		void OrderStopsByLocality();
 		IdEgeInfoForPrint GetEdgeInfoForPrint(const graph::EdgeId id) const;
 
 		void CreateEdgeFromAndToByStops(std::vector<Stop*> all_stops_ptr_);
-		void MakeEdgeBus(const Bus* ptr_bus);
+		void MakeEdgeBus(const Bus* ptr_bus, EdgeBuffer& edges) const;
+		void AddEdges(const EdgeBuffer& edges);
+		void CreateCompactGraph(const std::vector<Bus*>& list_ptr_buses, concurrency::ThreadPool& thread_pool);
+		void MakeRideChain(const Bus* ptr_bus, bool is_forward, graph::VertexId first_ride_vertex, EdgeBuffer& edges) const;
+		void CollapseParallelEdges();
+		uint64_t ComputeFingerprint() const;
+		bool SaveRoutingFile(const std::vector<graph::CompactRouteCell>& routes, uint64_t fingerprint) const;
+		template <typename Weight>
+		std::unique_ptr<graph::RouteEngine<Weight>> MakeRouter(const graph::DirectedWeightedGraph<Weight>& graph,
+			const graph::CsrGraph<Weight>& csr_graph) const;
+		template <typename Weight>
+		void UpdateRouter(const graph::DirectedWeightedGraph<Weight>& old_graph, const graph::DirectedWeightedGraph<Weight>& graph,
+			graph::CsrGraph<Weight>& csr_graph, std::unique_ptr<graph::RouteEngine<Weight>>& router) const;
+		template <typename Weight>
+		std::optional<double> VisitRouteByEngine(const graph::RouteEngine<Weight>& engine, const Stop* from, const Stop* to,
+			RouteItemVisitor& visitor) const;
+		template <typename Weight>
+		std::vector<std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>>> BuildRoutesByEngine(const graph::RouteEngine<Weight>& engine,
+			const Stop* from, const std::vector<const Stop*>& to) const;
+		template <typename Weight>
+		graph::EdgeOverlay<Weight> MakeOverlay(const graph::CsrGraph<Weight>& graph, const RouteClosures& closures,
+			const RoutingProfile* profile, std::unordered_map<graph::EdgeId, AlternativeTrip>& replaced_trips) const;
+		template <typename Weight>
+		std::optional<SetRoute> BuildRouteBetweenSetsInGraph(const graph::CsrGraph<Weight>& graph, const std::vector<RouteEndpoint>& from,
+			const std::vector<RouteEndpoint>& to, const RouteClosures& closures, const RoutingProfile* profile) const;
+		template <typename Weight>
+		std::vector<std::pair<Stop*, double>> FindReachableStopsInGraph(const graph::CsrGraph<Weight>& graph, const Stop* from,
+			double max_time, const RouteClosures& closures, const RoutingProfile* profile) const;
+		template <typename Weight>
+		std::vector<std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>>> BuildRoutesWithOptions(const graph::CsrGraph<Weight>& graph,
+			const Stop* from, const std::vector<const Stop*>& to, const RouteClosures& closures, const RoutingProfile* profile) const;
+		template <typename Weight>
+		std::optional<std::pair<std::vector<IdEgeInfoForPrint>, double>> MakeRouteAnswer(
+			const std::optional<typename graph::RouteEngine<Weight>::RouteInfo>& route_info,
+			const std::unordered_map<graph::EdgeId, AlternativeTrip>& replaced_trips, const RoutingProfile* profile) const;
+		double GetEdgeTime(graph::EdgeId edge_id, const std::unordered_map<graph::EdgeId, AlternativeTrip>& replaced_trips,
+			const RoutingProfile* profile) const;
+		double ComputeGeoFactor() const;
+		double ComputeLowerBound(graph::VertexId from, graph::VertexId to, double geo_factor) const;
 
 	};
 }// router::
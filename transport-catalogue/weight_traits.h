@@ -0,0 +1,32 @@
+#pragma once
+
+#include <limits>
+#include <type_traits>
+
+namespace graph {
+
+// Особые значения весов ребер для маршрутизаторов.
+// Вещественные веса используют бесконечность как вес недостижимой вершины
+template <typename Weight, typename = void>
+struct WeightTraits {
+    static constexpr Weight ZERO{};
+    static constexpr Weight INFINITE = std::numeric_limits<Weight>::infinity();
+
+    static constexpr Weight Add(Weight lhs, Weight rhs) {
+        return lhs + rhs;
+    }
+};
+
+// Целочисленные веса (время в фиксированных единицах): бесконечность - максимальное значение,
+// сложение с насыщением, чтобы сумма с бесконечностью не переполнялась
+template <typename Weight>
+struct WeightTraits<Weight, std::enable_if_t<std::is_integral_v<Weight>>> {
+    static constexpr Weight ZERO{};
+    static constexpr Weight INFINITE = std::numeric_limits<Weight>::max();
+
+    static constexpr Weight Add(Weight lhs, Weight rhs) {
+        return lhs > INFINITE - rhs ? INFINITE : static_cast<Weight>(lhs + rhs);
+    }
+};
+
+}  // namespace graph